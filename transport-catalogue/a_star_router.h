@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_space.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Оценка снизу веса маршрута от vertex до target. Оценка должна быть допустимой
+// (не больше настоящего веса), тогда найденный маршрут будет кратчайшим
+template <typename Weight>
+using Heuristic = std::function<Weight(VertexId vertex, VertexId target)>;
+
+// Поиск A*: Дейкстра, которая в первую очередь раскрывает вершины, ближайшие к цели по оценке.
+// Если оценка допустима, но не согласована, уже раскрытые вершины открываются повторно
+template <typename Weight>
+class AStarRouter : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    AStarRouter(const Graph& graph, Heuristic<Weight> heuristic);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    // оценка полного веса, вес от начала и вершина
+    using QueueItem = std::tuple<Weight, Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct VertexState {
+        std::optional<Weight> weight;
+        std::optional<Weight> estimate;
+        std::optional<EdgeId> prev_edge;
+        bool closed = false;
+    };
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Heuristic<Weight> heuristic_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, Heuristic<Weight> heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    graph.CheckNonNegativeWeights();
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+    VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    static thread_local SearchSpace<VertexState> states;
+    states.Reset(graph_.GetVertexCount());
+    Queue queue;
+
+    const auto push = [&](VertexId vertex, Weight weight) {
+        auto& state = states.Touch(vertex);
+        if (!state.estimate) {
+            state.estimate = heuristic_(vertex, to);
+        }
+        queue.push({ weight + *state.estimate, weight, vertex });
+    };
+
+    states.Touch(from).weight = ZERO_WEIGHT;
+    push(from, ZERO_WEIGHT);
+
+    while (!queue.empty()) {
+        const auto [_, weight, vertex] = queue.top();
+        queue.pop();
+        if (states[vertex].closed || weight != *states[vertex].weight) {
+            continue;
+        }
+        states.Touch(vertex).closed = true;
+        if (vertex == to) {
+            break;
+        }
+        const auto relax_edge = [&, weight = weight](EdgeId edge_id, VertexId vertex_to, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            if (!states[vertex_to].weight || candidate_weight < *states[vertex_to].weight) {
+                auto& state_to = states.Touch(vertex_to);
+                state_to.weight = candidate_weight;
+                state_to.prev_edge = edge_id;
+                state_to.closed = false;
+                push(vertex_to, candidate_weight);
+            }
+        };
+        graph_.ForEachOutgoingEdge(vertex, relax_edge);
+    }
+
+    if (!states[to].closed) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = states[to].prev_edge;
+        edge_id;
+        edge_id = states[graph_.GetEdgeUnchecked(*edge_id).from].prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ *states[to].weight, std::move(edges) };
+}
+
+}  // namespace graph
\ No newline at end of file
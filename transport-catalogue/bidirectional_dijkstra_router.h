@@ -0,0 +1,166 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_space.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дейкстра сразу с двух концов: прямой поиск из from по исходящим рёбрам
+// и обратный из to по входящим. Граф должен хранить обратные рёбра
+template <typename Weight>
+class BidirectionalDijkstraRouter : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    enum Direction {
+        FORWARD,
+        BACKWARD,
+    };
+
+    struct VertexState {
+        std::optional<Weight> weight;
+        // ребро к предыдущей вершине маршрута в прямом поиске, к следующей - в обратном
+        std::optional<EdgeId> edge;
+        bool settled = false;
+    };
+
+    template <typename Func>
+    void ForEachEdge(Direction direction, VertexId vertex, const Func& func) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph.HasReverseEdges()) {
+        throw std::invalid_argument("Bidirectional search needs a graph with reverse edges");
+    }
+    graph.CheckNonNegativeWeights();
+}
+
+// Вызывает func(edge_id, другой конец ребра, вес) для рёбер вершины в направлении поиска
+template <typename Weight>
+template <typename Func>
+void BidirectionalDijkstraRouter<Weight>::ForEachEdge(Direction direction, VertexId vertex, const Func& func) const {
+    if (direction == FORWARD) {
+        graph_.ForEachOutgoingEdge(vertex, func);
+    }
+    else {
+        graph_.ForEachIncomingEdge(vertex, func);
+    }
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo> BidirectionalDijkstraRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ ZERO_WEIGHT, {} };
+    }
+    static thread_local std::array<SearchSpace<VertexState>, 2> states;
+    states[FORWARD].Reset(graph_.GetVertexCount());
+    states[BACKWARD].Reset(graph_.GetVertexCount());
+    std::array<Queue, 2> queues;
+    states[FORWARD].Touch(from).weight = ZERO_WEIGHT;
+    queues[FORWARD].push({ ZERO_WEIGHT, from });
+    states[BACKWARD].Touch(to).weight = ZERO_WEIGHT;
+    queues[BACKWARD].push({ ZERO_WEIGHT, to });
+
+    // лучший найденный маршрут: вес и ребро, на котором встретились поиски
+    std::optional<Weight> best_weight;
+    std::optional<EdgeId> meeting_edge;
+
+    const auto pop_stale = [&](Direction direction) {
+        auto& queue = queues[direction];
+        while (!queue.empty() && states[direction][queue.top().second].settled) {
+            queue.pop();
+        }
+    };
+
+    while (true) {
+        pop_stale(FORWARD);
+        pop_stale(BACKWARD);
+        // любой ещё не найденный маршрут не легче суммы минимумов обеих очередей
+        if (queues[FORWARD].empty() || queues[BACKWARD].empty()
+            || (best_weight && queues[FORWARD].top().first + queues[BACKWARD].top().first >= *best_weight)) {
+            break;
+        }
+        const Direction direction = queues[FORWARD].top().first <= queues[BACKWARD].top().first
+            ? FORWARD : BACKWARD;
+        const Direction opposite = direction == FORWARD ? BACKWARD : FORWARD;
+        const auto [weight, vertex] = queues[direction].top();
+        queues[direction].pop();
+        states[direction].Touch(vertex).settled = true;
+
+        ForEachEdge(direction, vertex, [&, weight = weight](EdgeId edge_id, VertexId vertex_to, Weight edge_weight) {
+            const auto& state_to = states[direction][vertex_to];
+            const Weight candidate_weight = weight + edge_weight;
+            if (!state_to.settled && (!state_to.weight || candidate_weight < *state_to.weight)) {
+                auto& touched_state = states[direction].Touch(vertex_to);
+                touched_state.weight = candidate_weight;
+                touched_state.edge = edge_id;
+                queues[direction].push({ candidate_weight, vertex_to });
+            }
+            const auto& opposite_weight = states[opposite][vertex_to].weight;
+            if (opposite_weight && (!best_weight || candidate_weight + *opposite_weight < *best_weight)) {
+                best_weight = candidate_weight + *opposite_weight;
+                meeting_edge = edge_id;
+            }
+        });
+    }
+
+    if (!meeting_edge) {
+        return std::nullopt;
+    }
+    // собираем рёбра от from до ребра встречи и от него до to
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = states[FORWARD][graph_.GetEdgeUnchecked(*meeting_edge).from].edge;
+        edge_id;
+        edge_id = states[FORWARD][graph_.GetEdgeUnchecked(*edge_id).from].edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    edges.push_back(*meeting_edge);
+    for (std::optional<EdgeId> edge_id = states[BACKWARD][graph_.GetEdgeUnchecked(*meeting_edge).to].edge;
+        edge_id;
+        edge_id = states[BACKWARD][graph_.GetEdgeUnchecked(*edge_id).to].edge)
+    {
+        edges.push_back(*edge_id);
+    }
+
+    // вес складываем вдоль маршрута, как это делает поиск в одну сторону
+    Weight route_weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        route_weight = route_weight + graph_.GetEdgeUnchecked(edge_id).weight;
+    }
+    return RouteInfo{ route_weight, std::move(edges) };
+}
+
+}  // namespace graph
\ No newline at end of file
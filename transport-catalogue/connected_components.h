@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Компоненты связности графа для быстрой проверки, что маршрута точно нет.
+// Сильные компоненты нумеруются алгоритмом Тарьяна в обратном топологическом порядке:
+// если из компоненты A достижима другая компонента B, то номер B меньше номера A.
+// Слабые компоненты отделяют друг от друга несвязанные части сети. От весов рёбер компоненты
+// не зависят, поэтому строятся по графу с любым типом веса
+class ConnectedComponents {
+public:
+    ConnectedComponents() = default;
+    template <typename Weight>
+    explicit ConnectedComponents(const DirectedWeightedGraph<Weight>& graph);
+
+    // false - маршрута из from в to точно нет, true - маршрут возможен
+    bool MayReach(VertexId from, VertexId to) const {
+        return weak_components_[from] == weak_components_[to]
+            && strong_components_[from] >= strong_components_[to];
+    }
+
+    size_t GetStrongComponentCount() const {
+        return strong_component_count_;
+    }
+    size_t GetWeakComponentCount() const {
+        return weak_component_count_;
+    }
+
+private:
+    template <typename Weight>
+    void ComputeStrongComponents(const DirectedWeightedGraph<Weight>& graph);
+    template <typename Weight>
+    void ComputeWeakComponents(const DirectedWeightedGraph<Weight>& graph);
+
+    std::vector<uint32_t> strong_components_;
+    std::vector<uint32_t> weak_components_;
+    size_t strong_component_count_ = 0;
+    size_t weak_component_count_ = 0;
+};
+
+template <typename Weight>
+ConnectedComponents::ConnectedComponents(const DirectedWeightedGraph<Weight>& graph) {
+    ComputeStrongComponents(graph);
+    ComputeWeakComponents(graph);
+}
+
+// Тарьян без рекурсии: стек вызовов хранит вершину и ещё не просмотренные рёбра,
+// поэтому длинные цепочки остановок не переполняют стек потока
+template <typename Weight>
+void ConnectedComponents::ComputeStrongComponents(const DirectedWeightedGraph<Weight>& graph) {
+    static const size_t UNVISITED = std::numeric_limits<size_t>::max();
+    const size_t vertex_count = graph.GetVertexCount();
+
+    struct Frame {
+        VertexId vertex;
+        const EdgeId* next_edge;
+        const EdgeId* end_edge;
+    };
+
+    std::vector<size_t> order(vertex_count, UNVISITED);
+    std::vector<size_t> low_links(vertex_count, 0);
+    std::vector<bool> on_stack(vertex_count, false);
+    std::vector<VertexId> stack;
+    std::vector<Frame> calls;
+    size_t visited_count = 0;
+    strong_components_.assign(vertex_count, 0);
+    strong_component_count_ = 0;
+
+    const auto visit = [&](VertexId vertex) {
+        order[vertex] = low_links[vertex] = visited_count++;
+        stack.push_back(vertex);
+        on_stack[vertex] = true;
+        const auto edges = graph.GetIncidentEdges(vertex);
+        calls.push_back({ vertex, edges.begin(), edges.end() });
+    };
+
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        if (order[root] != UNVISITED) {
+            continue;
+        }
+        visit(root);
+        while (!calls.empty()) {
+            Frame& frame = calls.back();
+            const VertexId vertex = frame.vertex;
+            if (frame.next_edge != frame.end_edge) {
+                const VertexId vertex_to = graph.GetEdge(*frame.next_edge++).to;
+                if (order[vertex_to] == UNVISITED) {
+                    visit(vertex_to);
+                }
+                else if (on_stack[vertex_to]) {
+                    low_links[vertex] = std::min(low_links[vertex], order[vertex_to]);
+                }
+                continue;
+            }
+
+            // все рёбра просмотрены: вершина либо корень компоненты, либо передаёт low-link родителю
+            if (low_links[vertex] == order[vertex]) {
+                VertexId member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    strong_components_[member] = static_cast<uint32_t>(strong_component_count_);
+                } while (member != vertex);
+                ++strong_component_count_;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                const VertexId parent = calls.back().vertex;
+                low_links[parent] = std::min(low_links[parent], low_links[vertex]);
+            }
+        }
+    }
+}
+
+// Система непересекающихся множеств по рёбрам без учёта направления
+template <typename Weight>
+void ConnectedComponents::ComputeWeakComponents(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<VertexId> parents(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        parents[vertex] = vertex;
+    }
+    const auto find_root = [&parents](VertexId vertex) {
+        while (parents[vertex] != vertex) {
+            parents[vertex] = parents[parents[vertex]];
+            vertex = parents[vertex];
+        }
+        return vertex;
+    };
+
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        const VertexId root_from = find_root(edge.from);
+        const VertexId root_to = find_root(edge.to);
+        if (root_from != root_to) {
+            parents[std::max(root_from, root_to)] = std::min(root_from, root_to);
+        }
+    }
+
+    // корни получают номера подряд в порядке вершин
+    static const uint32_t NO_COMPONENT = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> root_components(vertex_count, NO_COMPONENT);
+    weak_components_.assign(vertex_count, 0);
+    weak_component_count_ = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find_root(vertex);
+        if (root_components[root] == NO_COMPONENT) {
+            root_components[root] = static_cast<uint32_t>(weak_component_count_++);
+        }
+        weak_components_[vertex] = root_components[root];
+    }
+}
+
+}  // namespace graph
\ No newline at end of file
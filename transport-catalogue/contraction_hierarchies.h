@@ -0,0 +1,465 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_space.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class ContractionHierarchy : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    explicit ContractionHierarchy(const Graph& graph);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    static constexpr size_t NO_EDGE = static_cast<size_t>(-1);
+    static constexpr size_t WITNESS_SEARCH_LIMIT = 500;
+
+    // Ребро иерархии: либо ребро исходного графа, либо шорткат из двух рёбер иерархии
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId original_edge = NO_EDGE;
+        size_t first_half = NO_EDGE;
+        size_t second_half = NO_EDGE;
+    };
+
+    struct UpwardArc {
+        VertexId head;
+        Weight weight;
+        size_t edge;
+    };
+
+    // рёбра к вершинам с бОльшим рангом в формате CSR
+    struct UpwardGraph {
+        std::vector<size_t> offsets;
+        std::vector<UpwardArc> arcs;
+    };
+
+    struct Shortcut {
+        size_t first_half;
+        size_t second_half;
+        Weight weight;
+    };
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct VertexState {
+        std::optional<Weight> weight;
+        // ребро иерархии к предыдущей вершине поиска
+        size_t prev_edge = NO_EDGE;
+    };
+
+    void AddOriginalEdges(const Graph& graph);
+    void ContractVertices();
+    void BuildUpwardGraphs();
+
+    void SearchWitnesses(VertexId source, VertexId vertex, Weight max_weight, size_t targets_count);
+    std::vector<Shortcut> FindShortcuts(VertexId vertex);
+    int ComputePriority(VertexId vertex, size_t shortcuts_count) const;
+    void ContractVertex(VertexId vertex, const std::vector<Shortcut>& shortcuts);
+    size_t AddHierarchyEdge(HierarchyEdge edge);
+
+    static void Settle(const UpwardGraph& upward_graph, const UpwardGraph& opposite_graph,
+        SearchSpace<VertexState>& search_space, Queue& queue, VertexId vertex, Weight weight);
+    // дописывает исходные рёбра шортката в edges, а их веса - к route_weight
+    void UnpackEdge(size_t edge, std::vector<EdgeId>& edges, Weight& route_weight) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    size_t vertex_count_ = 0;
+    std::vector<HierarchyEdge> edges_;
+
+    // используются только при построении иерархии
+    std::vector<std::vector<size_t>> out_edges_;
+    std::vector<std::vector<size_t>> in_edges_;
+    std::vector<int> contracted_neighbours_;
+    std::vector<bool> is_target_;
+    SearchSpace<VertexState> witness_search_;
+
+    std::vector<size_t> ranks_;
+    UpwardGraph forward_graph_;
+    UpwardGraph backward_graph_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : vertex_count_(graph.GetVertexCount())
+    , out_edges_(graph.GetVertexCount())
+    , in_edges_(graph.GetVertexCount())
+    , contracted_neighbours_(graph.GetVertexCount(), 0)
+    , is_target_(graph.GetVertexCount(), false)
+    , ranks_(graph.GetVertexCount(), 0)
+{
+    AddOriginalEdges(graph);
+    ContractVertices();
+    BuildUpwardGraphs();
+
+    out_edges_.clear();
+    out_edges_.shrink_to_fit();
+    in_edges_.clear();
+    in_edges_.shrink_to_fit();
+    contracted_neighbours_.clear();
+    contracted_neighbours_.shrink_to_fit();
+    is_target_.clear();
+    is_target_.shrink_to_fit();
+    witness_search_ = {};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::AddOriginalEdges(const Graph& graph) {
+    // из параллельных рёбер кратчайшим путём может быть только самое лёгкое
+    graph.CheckNonNegativeWeights();
+    std::vector<size_t> lightest_edges(vertex_count_, NO_EDGE);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        const size_t first_edge = edges_.size();
+        for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.to == edge.from) {
+                continue;
+            }
+            size_t& lightest_edge = lightest_edges[edge.to];
+            if (lightest_edge == NO_EDGE) {
+                lightest_edge = AddHierarchyEdge({ edge.from, edge.to, edge.weight, edge_id });
+            }
+            else if (edge.weight < edges_[lightest_edge].weight) {
+                edges_[lightest_edge].weight = edge.weight;
+                edges_[lightest_edge].original_edge = edge_id;
+            }
+        }
+        for (size_t id = first_edge; id < edges_.size(); ++id) {
+            lightest_edges[edges_[id].to] = NO_EDGE;
+        }
+    }
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::AddHierarchyEdge(HierarchyEdge edge) {
+    edges_.push_back(edge);
+    const size_t id = edges_.size() - 1;
+    out_edges_[edge.from].push_back(id);
+    in_edges_[edge.to].push_back(id);
+    return id;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::SearchWitnesses(VertexId source, VertexId vertex, Weight max_weight,
+    size_t targets_count) {
+    witness_search_.Reset(vertex_count_);
+    Queue queue;
+    witness_search_.Touch(source) = { ZERO_WEIGHT, NO_EDGE };
+    queue.push({ ZERO_WEIGHT, source });
+
+    size_t settled_count = 0;
+    size_t targets_left = is_target_[source] ? targets_count - 1 : targets_count;
+    while (!queue.empty() && settled_count < WITNESS_SEARCH_LIMIT && targets_left > 0) {
+        const auto [weight, current] = queue.top();
+        queue.pop();
+        if (*witness_search_[current].weight < weight) {
+            continue;
+        }
+        if (max_weight < weight) {
+            break;
+        }
+        ++settled_count;
+        if (is_target_[current] && current != source) {
+            --targets_left;
+        }
+        for (const size_t edge : out_edges_[current]) {
+            const VertexId next = edges_[edge].to;
+            if (next == vertex) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edges_[edge].weight;
+            if (!witness_search_[next].weight || candidate_weight < *witness_search_[next].weight) {
+                witness_search_.Touch(next) = { candidate_weight, edge };
+                queue.push({ candidate_weight, next });
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Shortcut> ContractionHierarchy<Weight>::FindShortcuts(
+    VertexId vertex) {
+    std::vector<Shortcut> shortcuts;
+
+    // свидетель возможен только для целей, в которые есть рёбра в обход vertex
+    size_t targets_count = 0;
+    for (const size_t out_edge : out_edges_[vertex]) {
+        const VertexId target = edges_[out_edge].to;
+        const auto& target_edges = in_edges_[target];
+        if (!is_target_[target] && std::any_of(target_edges.begin(), target_edges.end(),
+            [this, vertex](size_t edge) { return edges_[edge].from != vertex; })) {
+            is_target_[target] = true;
+            ++targets_count;
+        }
+    }
+
+    for (const size_t in_edge : in_edges_[vertex]) {
+        const VertexId source = edges_[in_edge].from;
+        std::optional<Weight> max_weight;
+        for (const size_t out_edge : out_edges_[vertex]) {
+            const Weight weight = edges_[in_edge].weight + edges_[out_edge].weight;
+            if (edges_[out_edge].to != source && (!max_weight || *max_weight < weight)) {
+                max_weight = weight;
+            }
+        }
+        if (!max_weight) {
+            continue;
+        }
+
+        // локальный поиск свидетеля: путь от source в обход vertex, не длиннее шортката
+        witness_search_.Reset(vertex_count_);
+        if (targets_count > 0) {
+            SearchWitnesses(source, vertex, *max_weight, targets_count);
+        }
+
+        for (const size_t out_edge : out_edges_[vertex]) {
+            const VertexId target = edges_[out_edge].to;
+            if (target == source) {
+                continue;
+            }
+            const Weight weight = edges_[in_edge].weight + edges_[out_edge].weight;
+            const auto& witness_weight = witness_search_[target].weight;
+            if (!witness_weight || weight < *witness_weight) {
+                shortcuts.push_back({ in_edge, out_edge, weight });
+            }
+        }
+    }
+
+    for (const size_t out_edge : out_edges_[vertex]) {
+        is_target_[edges_[out_edge].to] = false;
+    }
+
+    return shortcuts;
+}
+
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(VertexId vertex, size_t shortcuts_count) const {
+    const size_t removed_edges = in_edges_[vertex].size() + out_edges_[vertex].size();
+    return static_cast<int>(shortcuts_count) - static_cast<int>(removed_edges) + contracted_neighbours_[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractVertex(VertexId vertex, const std::vector<Shortcut>& shortcuts) {
+    for (const Shortcut& shortcut : shortcuts) {
+        AddHierarchyEdge({ edges_[shortcut.first_half].from, edges_[shortcut.second_half].to, shortcut.weight,
+            NO_EDGE, shortcut.first_half, shortcut.second_half });
+    }
+    // рёбра в сжатую вершину больше не участвуют в поисках свидетелей
+    const auto is_contracted_edge = [this, vertex](size_t edge) {
+        return edges_[edge].from == vertex || edges_[edge].to == vertex;
+    };
+    for (const size_t edge : in_edges_[vertex]) {
+        const VertexId neighbour = edges_[edge].from;
+        ++contracted_neighbours_[neighbour];
+        auto& neighbour_edges = out_edges_[neighbour];
+        neighbour_edges.erase(std::remove_if(neighbour_edges.begin(), neighbour_edges.end(), is_contracted_edge),
+            neighbour_edges.end());
+    }
+    for (const size_t edge : out_edges_[vertex]) {
+        const VertexId neighbour = edges_[edge].to;
+        ++contracted_neighbours_[neighbour];
+        auto& neighbour_edges = in_edges_[neighbour];
+        neighbour_edges.erase(std::remove_if(neighbour_edges.begin(), neighbour_edges.end(), is_contracted_edge),
+            neighbour_edges.end());
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractVertices() {
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        queue.push({ ComputePriority(vertex, FindShortcuts(vertex).size()), vertex });
+    }
+
+    // ленивое обновление приоритетов: вершина сжимается, только если после пересчёта
+    // она всё ещё не хуже следующей в очереди
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        const std::vector<Shortcut> shortcuts = FindShortcuts(vertex);
+        const int priority = ComputePriority(vertex, shortcuts.size());
+        if (!queue.empty() && queue.top().first < priority) {
+            queue.push({ priority, vertex });
+            continue;
+        }
+        ContractVertex(vertex, shortcuts);
+        ranks_[vertex] = rank++;
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraphs() {
+    auto& forward_offsets = forward_graph_.offsets;
+    auto& backward_offsets = backward_graph_.offsets;
+    forward_offsets.assign(vertex_count_ + 1, 0);
+    backward_offsets.assign(vertex_count_ + 1, 0);
+    for (const HierarchyEdge& edge : edges_) {
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            ++forward_offsets[edge.from + 1];
+        }
+        else {
+            ++backward_offsets[edge.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        forward_offsets[vertex + 1] += forward_offsets[vertex];
+        backward_offsets[vertex + 1] += backward_offsets[vertex];
+    }
+
+    forward_graph_.arcs.resize(forward_offsets.back());
+    backward_graph_.arcs.resize(backward_offsets.back());
+    std::vector<size_t> forward_positions(forward_offsets.begin(), forward_offsets.end() - 1);
+    std::vector<size_t> backward_positions(backward_offsets.begin(), backward_offsets.end() - 1);
+    for (size_t id = 0; id < edges_.size(); ++id) {
+        const HierarchyEdge& edge = edges_[id];
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            forward_graph_.arcs[forward_positions[edge.from]++] = { edge.to, edge.weight, id };
+        }
+        else {
+            backward_graph_.arcs[backward_positions[edge.to]++] = { edge.from, edge.weight, id };
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Settle(const UpwardGraph& upward_graph, const UpwardGraph& opposite_graph,
+    SearchSpace<VertexState>& search_space, Queue& queue, VertexId vertex, Weight weight) {
+    // stall-on-demand: если в вершину есть более короткий путь сверху, её рёбра не нужны
+    for (size_t i = opposite_graph.offsets[vertex]; i < opposite_graph.offsets[vertex + 1]; ++i) {
+        const UpwardArc& arc = opposite_graph.arcs[i];
+        const auto& head_weight = search_space[arc.head].weight;
+        if (head_weight && *head_weight + arc.weight < weight) {
+            return;
+        }
+    }
+    for (size_t i = upward_graph.offsets[vertex]; i < upward_graph.offsets[vertex + 1]; ++i) {
+        const UpwardArc& arc = upward_graph.arcs[i];
+        const Weight candidate_weight = weight + arc.weight;
+        const auto& head_weight = search_space[arc.head].weight;
+        if (!head_weight || candidate_weight < *head_weight) {
+            search_space.Touch(arc.head) = { candidate_weight, arc.edge };
+            queue.push({ candidate_weight, arc.head });
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(size_t edge, std::vector<EdgeId>& edges, Weight& route_weight) const {
+    std::vector<size_t> stack{ edge };
+    while (!stack.empty()) {
+        const HierarchyEdge& current = edges_[stack.back()];
+        stack.pop_back();
+        if (current.original_edge != NO_EDGE) {
+            edges.push_back(current.original_edge);
+            route_weight = route_weight + current.weight;
+        }
+        else {
+            stack.push_back(current.second_half);
+            stack.push_back(current.first_half);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    static thread_local SearchSpace<VertexState> forward;
+    static thread_local SearchSpace<VertexState> backward;
+    forward.Reset(vertex_count_);
+    backward.Reset(vertex_count_);
+
+    Queue forward_queue;
+    Queue backward_queue;
+    forward.Touch(from) = { ZERO_WEIGHT, NO_EDGE };
+    backward.Touch(to) = { ZERO_WEIGHT, NO_EDGE };
+    forward_queue.push({ ZERO_WEIGHT, from });
+    backward_queue.push({ ZERO_WEIGHT, to });
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+
+    // двунаправленный поиск вверх по иерархии; каждое направление останавливается,
+    // как только его минимальный ключ не меньше лучшего найденного пути
+    while (!forward_queue.empty() || !backward_queue.empty()) {
+        const bool is_forward = backward_queue.empty()
+            || (!forward_queue.empty() && forward_queue.top().first <= backward_queue.top().first);
+        Queue& queue = is_forward ? forward_queue : backward_queue;
+        SearchSpace<VertexState>& search_space = is_forward ? forward : backward;
+        const SearchSpace<VertexState>& other_search_space = is_forward ? backward : forward;
+
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (best_weight && !(weight < *best_weight)) {
+            queue = {};
+            continue;
+        }
+        if (*search_space[vertex].weight < weight) {
+            continue;
+        }
+        if (const auto& other_weight = other_search_space[vertex].weight) {
+            const Weight candidate_weight = weight + *other_weight;
+            if (!best_weight || candidate_weight < *best_weight) {
+                best_weight = candidate_weight;
+                meeting_vertex = vertex;
+            }
+        }
+        if (is_forward) {
+            Settle(forward_graph_, backward_graph_, search_space, queue, vertex, weight);
+        }
+        else {
+            Settle(backward_graph_, forward_graph_, search_space, queue, vertex, weight);
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<size_t> forward_path;
+    for (VertexId vertex = meeting_vertex; forward[vertex].prev_edge != NO_EDGE;
+        vertex = edges_[forward[vertex].prev_edge].from) {
+        forward_path.push_back(forward[vertex].prev_edge);
+    }
+    std::reverse(forward_path.begin(), forward_path.end());
+
+    // вес складываем вдоль исходных рёбер маршрута, как это делает поиск в одну сторону,
+    // а не берём сумму весов шорткатов
+    std::vector<EdgeId> edges;
+    Weight route_weight = ZERO_WEIGHT;
+    for (const size_t edge : forward_path) {
+        UnpackEdge(edge, edges, route_weight);
+    }
+    for (VertexId vertex = meeting_vertex; backward[vertex].prev_edge != NO_EDGE;
+        vertex = edges_[backward[vertex].prev_edge].to) {
+        UnpackEdge(backward[vertex].prev_edge, edges, route_weight);
+    }
+
+    return RouteInfo{ route_weight, std::move(edges) };
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,139 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Целочисленный вес маршрута в десятых долях секунды. Сложение насыщающее:
+// при переполнении получается наибольшее значение, оно же означает недостижимость
+struct DeciSeconds {
+    static constexpr uint32_t INFINITE_VALUE = std::numeric_limits<uint32_t>::max();
+    static constexpr double PER_MINUTE = 600;
+
+    uint32_t value = 0;
+
+    // Время в десятых долях секунды округляется вверх до целого, поэтому вес маршрута не меньше настоящего.
+    // Время должно получаться из исходных данных одним умножением или делением: результат такой
+    // операции округлён точно, и целое число десятых долей не превращается в следующее
+    static DeciSeconds RoundUp(double deci_seconds) {
+        if (deci_seconds < 0) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        const double value = std::ceil(deci_seconds);
+        if (!(value < INFINITE_VALUE)) {
+            throw std::out_of_range("Weight doesn't fit in deci-seconds");
+        }
+        return { value > 0 ? static_cast<uint32_t>(value) : 0 };
+    }
+
+    // Одно деление целого числа: ближайшее к точному значению число double,
+    // одинаковое значение всегда даёт одинаковые минуты
+    double ToMinutes() const {
+        return value / PER_MINUTE;
+    }
+};
+
+constexpr DeciSeconds operator+(DeciSeconds lhs, DeciSeconds rhs) {
+    const uint32_t sum = lhs.value + rhs.value;
+    return { sum < lhs.value ? DeciSeconds::INFINITE_VALUE : sum };
+}
+
+// разность не бывает меньше нуля
+constexpr DeciSeconds operator-(DeciSeconds lhs, DeciSeconds rhs) {
+    return { lhs.value > rhs.value ? lhs.value - rhs.value : 0 };
+}
+
+constexpr bool operator==(DeciSeconds lhs, DeciSeconds rhs) {
+    return lhs.value == rhs.value;
+}
+
+constexpr bool operator!=(DeciSeconds lhs, DeciSeconds rhs) {
+    return !(lhs == rhs);
+}
+
+constexpr bool operator<(DeciSeconds lhs, DeciSeconds rhs) {
+    return lhs.value < rhs.value;
+}
+
+constexpr bool operator>(DeciSeconds lhs, DeciSeconds rhs) {
+    return rhs < lhs;
+}
+
+constexpr bool operator<=(DeciSeconds lhs, DeciSeconds rhs) {
+    return !(rhs < lhs);
+}
+
+constexpr bool operator>=(DeciSeconds lhs, DeciSeconds rhs) {
+    return !(lhs < rhs);
+}
+
+template <>
+struct IsSaturatingUint32Weight<DeciSeconds> : std::true_type {};
+
+} // namespace graph
+
+// Бесконечности у типа нет, её роль играет max(): так её находит таблица маршрутов
+namespace std {
+
+template <>
+struct numeric_limits<graph::DeciSeconds> {
+    static constexpr bool is_specialized = true;
+    static constexpr bool has_infinity = false;
+
+    static constexpr graph::DeciSeconds min() noexcept {
+        return {};
+    }
+    static constexpr graph::DeciSeconds max() noexcept {
+        return { graph::DeciSeconds::INFINITE_VALUE };
+    }
+    static constexpr graph::DeciSeconds infinity() noexcept {
+        return max();
+    }
+};
+
+} // namespace std
+
+namespace graph {
+
+// Движок с ответами в минутах поверх движка, который ищет маршруты по графу с весами
+// в десятых долях секунды. Сам граф строится сразу с такими весами и не копируется
+class DeciSecondsRoutingEngine : public RoutingEngine<double> {
+public:
+    explicit DeciSecondsRoutingEngine(std::unique_ptr<RoutingEngine<DeciSeconds>> engine)
+        : engine_(std::move(engine))
+    {
+    }
+
+    std::optional<RouteInfo<double>> BuildRoute(VertexId from, VertexId to) const override {
+        auto route = engine_->BuildRoute(from, to);
+        if (!route) {
+            return std::nullopt;
+        }
+        return RouteInfo<double>{ route->weight.ToMinutes(), std::move(route->edges) };
+    }
+
+    std::vector<std::optional<double>> BuildWeights(VertexId from, const std::vector<VertexId>& to) const override {
+        std::vector<std::optional<double>> weights;
+        weights.reserve(to.size());
+        for (const auto& weight : engine_->BuildWeights(from, to)) {
+            weights.push_back(weight ? std::optional<double>(weight->ToMinutes()) : std::nullopt);
+        }
+        return weights;
+    }
+
+private:
+    std::unique_ptr<RoutingEngine<DeciSeconds>> engine_;
+};
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+#include "search_space.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+template <typename Weight>
+class DijkstraRouter : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    explicit DijkstraRouter(const Graph& graph);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+private:
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct VertexState {
+        std::optional<Weight> weight;
+        std::optional<EdgeId> prev_edge;
+        bool settled = false;
+        bool target = false;
+    };
+
+    // поиск из from, который заканчивается, как только осядут все вершины targets;
+    // результат лежит в пространстве поиска потока и действителен до следующего поиска
+    const SearchSpace<VertexState>& Search(VertexId from, const std::vector<VertexId>& targets) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    graph.CheckNonNegativeWeights();
+}
+
+template <typename Weight>
+const SearchSpace<typename DijkstraRouter<Weight>::VertexState>& DijkstraRouter<Weight>::Search(VertexId from,
+    const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    for (const VertexId target : targets) {
+        if (target >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+
+    static thread_local SearchSpace<VertexState> states;
+    states.Reset(vertex_count);
+    size_t targets_left = 0;
+    for (const VertexId target : targets) {
+        if (!states[target].target) {
+            states.Touch(target).target = true;
+            ++targets_left;
+        }
+    }
+    Queue queue;
+
+    states.Touch(from).weight = ZERO_WEIGHT;
+    queue.push({ ZERO_WEIGHT, from });
+
+    while (!queue.empty() && targets_left > 0) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (states[vertex].settled) {
+            continue;
+        }
+        states.Touch(vertex).settled = true;
+        if (states[vertex].target && --targets_left == 0) {
+            break;
+        }
+        const auto relax_edge = [&, weight = weight](EdgeId edge_id, VertexId vertex_to, Weight edge_weight) {
+            const auto& state_to = states[vertex_to];
+            const Weight candidate_weight = weight + edge_weight;
+            if (!state_to.settled && (!state_to.weight || candidate_weight < *state_to.weight)) {
+                auto& touched_state = states.Touch(vertex_to);
+                touched_state.weight = candidate_weight;
+                touched_state.prev_edge = edge_id;
+                queue.push({ candidate_weight, vertex_to });
+            }
+        };
+        graph_.ForEachOutgoingEdge(vertex, relax_edge);
+    }
+
+    return states;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+    VertexId to) const {
+    const auto& states = Search(from, { to });
+    if (!states[to].settled) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = states[to].prev_edge;
+        edge_id;
+        edge_id = states[graph_.GetEdgeUnchecked(*edge_id).from].prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ *states[to].weight, std::move(edges) };
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> DijkstraRouter<Weight>::BuildWeights(VertexId from,
+    const std::vector<VertexId>& to) const {
+    const auto& states = Search(from, to);
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        weights.push_back(states[vertex_to].settled ? states[vertex_to].weight : std::nullopt);
+    }
+    return weights;
+}
+
+}  // namespace graph
\ No newline at end of file
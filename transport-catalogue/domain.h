@@ -13,30 +13,38 @@
 #pragma once
 
 #include "geo.h"
+#include "ranges.h"
 
-#include <set>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <variant>
 #include <vector>
 
 // мы намеренно не используем namespace, так как domain, это основные объекты, которые встречаются
 // во многих частях программы.
 
-using Buses = std::set<std::string_view>;
+// названия автобусов остановки, упорядоченные и без повторов; массив хранит справочник
+using Buses = ranges::Range<std::vector<std::string_view>::const_iterator>;
 
 using Distance = int;
 
+// плотные номера остановок и автобусов в порядке добавления в справочник
+using StopId = uint32_t;
+using BusId = uint32_t;
+
 struct Stop {
     std::string name;
     geo::Coordinates coordinates;
+    StopId id = 0; // назначает справочник
 };
 
 struct Bus {
     std::string name;
     std::vector<Stop*> stops;
     bool is_round = false;
+    BusId id = 0; // назначает справочник
 };
 
 struct BusResponse {
@@ -49,7 +57,7 @@ struct BusResponse {
 
 struct StopResponse {
     bool stop_exist = false;
-    std::vector<std::string_view> buses;
+    Buses buses;
 };
 
 // timecut type
@@ -72,10 +80,45 @@ struct RouteResponse {
     std::vector<Timecut> time_cuts; // it could be waiting on a stop or riding on a bus.
 };
 
-using BusesTable = std::unordered_map<std::string_view, Bus*>;
-using StopsTable = std::unordered_map<std::string_view, Stop*>;
+// total times from every origin (rows) to every destination (columns), nullopt if unreachable
+using TravelTimeMatrix = std::vector<std::vector<std::optional<double>>>;
+
+// автобусы и остановки, упорядоченные по названию; массивы хранит справочник, диапазон ничего не копирует
+using SortedBuses = ranges::Range<std::vector<const Bus*>::const_iterator>;
+using SortedStops = ranges::Range<std::vector<const Stop*>::const_iterator>;
+
+enum class RouterType {
+    ALL_PAIRS, // Floyd-Warshall precomputation of all routes
+    DIJKSTRA, // on-demand search for every query
+    CONTRACTION_HIERARCHIES, // shortcuts precomputation and bidirectional search
+    RAPTOR, // round-based scanning of bus routes, no routing graph at all
+    A_STAR, // on-demand search directed by the straight-line distance to the target
+    BIDIRECTIONAL_DIJKSTRA, // on-demand search from both ends, the graph keeps reverse edges
+    SHORTEST_PATH_TREES, // full search per origin, recently used trees are cached within a memory budget
+};
+
+enum class WarmUpMode {
+    LAZY, // the router is built by the first route request
+    EAGER, // the router is built together with the transport router
+    BACKGROUND, // the router is built on a worker thread, requests wait for it
+};
+
+enum class GraphModel {
+    WAIT_EDGES, // two vertices per stop joined by a wait edge
+    BOARDING_WAIT, // one vertex per stop, the wait is added to the weight of every bus edge
+};
 
 struct RoutingSettings {
     double bus_wait_time; // in minutes
     double bus_velocity; // in km/h
+    RouterType router_type = RouterType::ALL_PAIRS;
+    bool use_huge_pages = false; // for the all-pairs routes table
+    size_t thread_count = 0; // 0 means all hardware threads
+    std::string snapshot_file; // prepared all-pairs routes table, empty means no snapshot
+    size_t route_cache_size = 0; // cached Route responses, 0 disables the cache
+    size_t tree_cache_bytes = 64 << 20; // memory for cached shortest path trees
+    WarmUpMode warm_up = WarmUpMode::LAZY;
+    GraphModel graph_model = GraphModel::WAIT_EDGES;
+    bool prune_parallel_edges = true; // keep only the lightest bus edge between two stops
+    bool use_integer_weights = false; // search on uint32 weights in tenths of a second, rounded up
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+﻿#include "flat_buffer.h"
+
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace graph {
+
+void* AllocateBuffer(size_t bytes, [[maybe_unused]] bool use_huge_pages) {
+#ifdef __linux__
+    if (use_huge_pages && bytes > 0) {
+        void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        // ядро может отказать в больших страницах, тогда останутся обычные
+        madvise(data, bytes, MADV_HUGEPAGE);
+        return data;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+void FreeBuffer(void* data, [[maybe_unused]] size_t bytes, [[maybe_unused]] bool use_huge_pages) {
+    if (data == nullptr) {
+        return;
+    }
+#ifdef __linux__
+    if (use_huge_pages && bytes > 0) {
+        munmap(data, bytes);
+        return;
+    }
+#endif
+    ::operator delete(data);
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace graph {
+
+void* AllocateBuffer(size_t bytes, bool use_huge_pages);
+void FreeBuffer(void* data, size_t bytes, bool use_huge_pages);
+
+// Непрерывный массив фиксированного размера, который выделяется один раз
+// и при необходимости размещается в больших страницах памяти
+template <typename T>
+class FlatBuffer {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "FlatBuffer stores only trivially copyable values");
+
+    FlatBuffer() = default;
+    FlatBuffer(size_t size, T value, bool use_huge_pages = false);
+
+    // Не владеющее представление чужой памяти, например отображённого в память файла
+    static FlatBuffer View(const T* data, size_t size);
+
+    T* Data() {
+        return data_.get();
+    }
+    const T* Data() const {
+        return data_.get();
+    }
+    size_t Size() const {
+        return size_;
+    }
+
+    T& operator[](size_t index) {
+        return data_.get()[index];
+    }
+    const T& operator[](size_t index) const {
+        return data_.get()[index];
+    }
+
+private:
+    struct Deleter {
+        size_t bytes = 0;
+        bool use_huge_pages = false;
+        bool owning = true;
+
+        void operator()(T* data) const {
+            if (owning) {
+                FreeBuffer(data, bytes, use_huge_pages);
+            }
+        }
+    };
+
+    std::unique_ptr<T, Deleter> data_;
+    size_t size_ = 0;
+};
+
+template <typename T>
+FlatBuffer<T>::FlatBuffer(size_t size, T value, bool use_huge_pages)
+    : data_(static_cast<T*>(AllocateBuffer(size * sizeof(T), use_huge_pages)),
+        Deleter{ size * sizeof(T), use_huge_pages })
+    , size_(size)
+{
+    std::fill(data_.get(), data_.get() + size, value);
+}
+
+template <typename T>
+FlatBuffer<T> FlatBuffer<T>::View(const T* data, size_t size) {
+    FlatBuffer buffer;
+    buffer.data_ = std::unique_ptr<T, Deleter>(const_cast<T*>(data), Deleter{ 0, false, false });
+    buffer.size_ = size;
+    return buffer;
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -21,39 +22,133 @@ template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<const EdgeId*>;
 
 public:
     DirectedWeightedGraph() = default;
-    explicit DirectedWeightedGraph(size_t vertex_count);
+    // с keep_reverse_edges граф хранит ещё и входящие рёбра каждой вершины для обратного поиска
+    explicit DirectedWeightedGraph(size_t vertex_count, bool keep_reverse_edges = false);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Переводит граф в сжатое построчное представление: исходящие рёбра всех вершин
+    // лежат подряд в одном массиве, после этого граф изменять нельзя
+    void Freeze();
+    bool IsFrozen() const;
+    bool HasReverseEdges() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+
+    // Вызывают func(edge_id, другой конец ребра, вес) для исходящих или входящих рёбер вершины.
+    // В замороженном графе рёбра берутся из сжатого представления без обращения к самим рёбрам
+    template <typename Func>
+    void ForEachOutgoingEdge(VertexId vertex, const Func& func) const;
+    template <typename Func>
+    void ForEachIncomingEdge(VertexId vertex, const Func& func) const;
+
+    // кидает domain_error, если в графе есть ребро с отрицательным весом
+    void CheckNonNegativeWeights() const;
+
+    // доступ к ребру без проверки номера для горячих циклов
+    const Edge<Weight>& GetEdgeUnchecked(EdgeId edge_id) const {
+        return edges_[edge_id];
+    }
 
 private:
+    // Списки рёбер всех вершин в одном массиве: рёбра вершины v - это [offsets[v], offsets[v + 1]),
+    // в vertices лежит другой конец каждого ребра
+    struct Adjacency {
+        std::vector<size_t> offsets;
+        std::vector<EdgeId> edges;
+        std::vector<VertexId> vertices;
+        std::vector<Weight> weights;
+    };
+
+    Adjacency BuildAdjacency(const std::vector<IncidenceList>& incidence_lists, bool reverse) const;
+    IncidentEdgesRange GetEdgesRange(const std::vector<IncidenceList>& incidence_lists,
+        const Adjacency& adjacency, VertexId vertex) const;
+
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    std::vector<IncidenceList> reverse_incidence_lists_;
+
+    bool keep_reverse_edges_ = false;
+    bool frozen_ = false;
+    Adjacency forward_;
+    Adjacency reverse_;
 };
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, bool keep_reverse_edges)
+    : incidence_lists_(vertex_count)
+    , reverse_incidence_lists_(keep_reverse_edges ? vertex_count : 0)
+    , keep_reverse_edges_(keep_reverse_edges) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (frozen_) {
+        throw std::logic_error("Can't add an edge to a frozen graph");
+    }
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
+    if (keep_reverse_edges_) {
+        reverse_incidence_lists_.at(edge.to).push_back(id);
+    }
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (frozen_) {
+        return;
+    }
+    forward_ = BuildAdjacency(incidence_lists_, false);
+    if (keep_reverse_edges_) {
+        reverse_ = BuildAdjacency(reverse_incidence_lists_, true);
+    }
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    std::vector<IncidenceList>().swap(reverse_incidence_lists_);
+    frozen_ = true;
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::Adjacency DirectedWeightedGraph<Weight>::BuildAdjacency(
+    const std::vector<IncidenceList>& incidence_lists, bool reverse) const {
+    Adjacency adjacency;
+    adjacency.offsets.reserve(incidence_lists.size() + 1);
+    adjacency.edges.reserve(edges_.size());
+    adjacency.vertices.reserve(edges_.size());
+    adjacency.weights.reserve(edges_.size());
+    adjacency.offsets.push_back(0);
+    for (const IncidenceList& incidence_list : incidence_lists) {
+        for (const EdgeId edge_id : incidence_list) {
+            adjacency.edges.push_back(edge_id);
+            adjacency.vertices.push_back(reverse ? edges_[edge_id].from : edges_[edge_id].to);
+            adjacency.weights.push_back(edges_[edge_id].weight);
+        }
+        adjacency.offsets.push_back(adjacency.edges.size());
+    }
+    return adjacency;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::HasReverseEdges() const {
+    return keep_reverse_edges_;
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return frozen_ ? forward_.offsets.size() - 1 : incidence_lists_.size();
 }
 
 template <typename Weight>
@@ -69,7 +164,74 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
     DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    return GetEdgesRange(incidence_lists_, forward_, vertex);
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+    DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+    if (!keep_reverse_edges_) {
+        throw std::logic_error("The graph doesn't keep reverse edges");
+    }
+    return GetEdgesRange(reverse_incidence_lists_, reverse_, vertex);
+}
+
+template <typename Weight>
+template <typename Func>
+void DirectedWeightedGraph<Weight>::ForEachOutgoingEdge(VertexId vertex, const Func& func) const {
+    if (frozen_) {
+        const size_t end = forward_.offsets[vertex + 1];
+        for (size_t position = forward_.offsets[vertex]; position < end; ++position) {
+            func(forward_.edges[position], forward_.vertices[position], forward_.weights[position]);
+        }
+        return;
+    }
+    for (const EdgeId edge_id : incidence_lists_[vertex]) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        func(edge_id, edge.to, edge.weight);
+    }
+}
+
+template <typename Weight>
+template <typename Func>
+void DirectedWeightedGraph<Weight>::ForEachIncomingEdge(VertexId vertex, const Func& func) const {
+    if (!keep_reverse_edges_) {
+        throw std::logic_error("The graph doesn't keep reverse edges");
+    }
+    if (frozen_) {
+        const size_t end = reverse_.offsets[vertex + 1];
+        for (size_t position = reverse_.offsets[vertex]; position < end; ++position) {
+            func(reverse_.edges[position], reverse_.vertices[position], reverse_.weights[position]);
+        }
+        return;
+    }
+    for (const EdgeId edge_id : reverse_incidence_lists_[vertex]) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        func(edge_id, edge.from, edge.weight);
+    }
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::CheckNonNegativeWeights() const {
+    for (const Edge<Weight>& edge : edges_) {
+        if (edge.weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgesRange DirectedWeightedGraph<Weight>::GetEdgesRange(
+    const std::vector<IncidenceList>& incidence_lists, const Adjacency& adjacency, VertexId vertex) const {
+    if (frozen_) {
+        if (vertex >= GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const EdgeId* data = adjacency.edges.data();
+        return { data + adjacency.offsets[vertex], data + adjacency.offsets[vertex + 1] };
+    }
+    const IncidenceList& incidence_list = incidence_lists.at(vertex);
+    return { incidence_list.data(), incidence_list.data() + incidence_list.size() };
 }
 
 }  // namespace graph
\ No newline at end of file
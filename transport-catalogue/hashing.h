@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include <cstdint>
+
+namespace hashing {
+
+// Перемешивание из splitmix64: соседние значения ключа не попадают в соседние корзины хеш-таблицы
+inline uint64_t MixBits(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace hashing
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include <functional>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -25,6 +26,9 @@ void JsonReader::ReadInput(std::istream& input) {
     render_settings_ = doc.GetRoot().AsMap().at("render_settings").AsMap();
     stat_requests_ = doc.GetRoot().AsMap().at("stat_requests").AsArray();
     routing_settings_ = doc.GetRoot().AsMap().at("routing_settings").AsMap();
+    if (doc.GetRoot().AsMap().count("serialization_settings")) {
+        serialization_settings_ = doc.GetRoot().AsMap().at("serialization_settings").AsMap();
+    }
 
     for (const auto& req : base_requests) {
         if (req.AsMap().at("type").AsString() == "Stop") {
@@ -62,6 +66,9 @@ transport_catalogue::TransportCatalogue JsonReader::CreateDatabase() {
         database.AddBus(std::move(bus));
     }
 
+    // справочник больше не меняется, статистика автобусов считается сразу
+    database.Freeze();
+
     return database;
 }
 
@@ -150,10 +157,97 @@ router::TransportRouter JsonReader::CreateTransportRouter(const transport_catalo
     RoutingSettings settings;
     settings.bus_wait_time = routing_settings_.at("bus_wait_time"s).AsInt();
     settings.bus_velocity = routing_settings_.at("bus_velocity"s).AsDouble();
+    if (routing_settings_.count("router_type"s)) {
+        settings.router_type = ParseRouterType(routing_settings_.at("router_type"s).AsString());
+    }
+    if (routing_settings_.count("use_huge_pages"s)) {
+        settings.use_huge_pages = routing_settings_.at("use_huge_pages"s).AsBool();
+    }
+    if (routing_settings_.count("thread_count"s)) {
+        settings.thread_count = ParseCount("thread_count"sv, routing_settings_.at("thread_count"s));
+    }
+    if (routing_settings_.count("route_cache_size"s)) {
+        settings.route_cache_size = ParseCount("route_cache_size"sv, routing_settings_.at("route_cache_size"s));
+    }
+    if (routing_settings_.count("tree_cache_bytes"s)) {
+        settings.tree_cache_bytes = ParseCount("tree_cache_bytes"sv, routing_settings_.at("tree_cache_bytes"s));
+    }
+    if (routing_settings_.count("warm_up"s)) {
+        settings.warm_up = ParseWarmUpMode(routing_settings_.at("warm_up"s).AsString());
+    }
+    if (routing_settings_.count("graph_model"s)) {
+        settings.graph_model = ParseGraphModel(routing_settings_.at("graph_model"s).AsString());
+    }
+    if (routing_settings_.count("prune_parallel_edges"s)) {
+        settings.prune_parallel_edges = routing_settings_.at("prune_parallel_edges"s).AsBool();
+    }
+    if (routing_settings_.count("use_integer_weights"s)) {
+        settings.use_integer_weights = routing_settings_.at("use_integer_weights"s).AsBool();
+    }
+    if (serialization_settings_.count("file"s)) {
+        settings.snapshot_file = serialization_settings_.at("file"s).AsString();
+    }
 
     return router::TransportRouter{ settings, catalogue };
 }
 
+RouterType JsonReader::ParseRouterType(std::string_view name) const {
+    if (name == "all_pairs"sv) {
+        return RouterType::ALL_PAIRS;
+    }
+    if (name == "dijkstra"sv) {
+        return RouterType::DIJKSTRA;
+    }
+    if (name == "contraction_hierarchies"sv) {
+        return RouterType::CONTRACTION_HIERARCHIES;
+    }
+    if (name == "raptor"sv) {
+        return RouterType::RAPTOR;
+    }
+    if (name == "a_star"sv) {
+        return RouterType::A_STAR;
+    }
+    if (name == "bidirectional_dijkstra"sv) {
+        return RouterType::BIDIRECTIONAL_DIJKSTRA;
+    }
+    if (name == "shortest_path_trees"sv) {
+        return RouterType::SHORTEST_PATH_TREES;
+    }
+    throw std::invalid_argument("Unknown router_type: "s + std::string(name));
+}
+
+WarmUpMode JsonReader::ParseWarmUpMode(std::string_view name) const {
+    if (name == "lazy"sv) {
+        return WarmUpMode::LAZY;
+    }
+    if (name == "eager"sv) {
+        return WarmUpMode::EAGER;
+    }
+    if (name == "background"sv) {
+        return WarmUpMode::BACKGROUND;
+    }
+    throw std::invalid_argument("Unknown warm_up: "s + std::string(name));
+}
+
+GraphModel JsonReader::ParseGraphModel(std::string_view name) const {
+    if (name == "wait_edges"sv) {
+        return GraphModel::WAIT_EDGES;
+    }
+    if (name == "boarding_wait"sv) {
+        return GraphModel::BOARDING_WAIT;
+    }
+    throw std::invalid_argument("Unknown graph_model: "s + std::string(name));
+}
+
+// количества и размеры не бывают отрицательными: -1 иначе превратился бы в огромный size_t
+size_t JsonReader::ParseCount(std::string_view name, const json::Node& value) const {
+    const int count = value.AsInt();
+    if (count < 0) {
+        throw std::invalid_argument(std::string(name) + " should be non-negative, got "s + std::to_string(count));
+    }
+    return static_cast<size_t>(count);
+}
+
 void JsonReader::ProceedBusRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const {
     // запрос информации об автобусе:
     BusResponse response = request_handler.GetBusInfo(request.AsMap().at("name").AsString());
@@ -257,6 +351,40 @@ void JsonReader::ProceedRouteRequest(const RequestHandler& request_handler, json
     }
 }
 
+void JsonReader::ProceedRouteMatrixRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const {
+    // запрос матрицы времени в пути от каждой остановки from до каждой остановки to:
+    std::vector<std::string_view> from;
+    for (const auto& stop_name : request.AsMap().at("from"s).AsArray()) {
+        from.push_back(stop_name.AsString());
+    }
+    std::vector<std::string_view> to;
+    for (const auto& stop_name : request.AsMap().at("to"s).AsArray()) {
+        to.push_back(stop_name.AsString());
+    }
+
+    TravelTimeMatrix matrix = request_handler.GetTravelTimes(from, to);
+
+    responses.StartDict()
+        .Key("request_id"s).Value(request.AsMap().at("id").AsInt())
+        .Key("total_times"s).StartArray();
+
+    for (const auto& row : matrix) {
+        // недостижимые остановки отмечаются null
+        responses.StartArray();
+        for (const auto& total_time : row) {
+            if (total_time) {
+                responses.Value(*total_time);
+            }
+            else {
+                responses.Value(nullptr);
+            }
+        }
+        responses.EndArray();
+    }
+
+    responses.EndArray().EndDict();
+}
+
 void JsonReader::RequestAndPrint(const RequestHandler& request_handler, std::ostream& out) const {
     json::Builder responses = json::Builder{};
     responses.StartArray();
@@ -274,6 +402,9 @@ void JsonReader::RequestAndPrint(const RequestHandler& request_handler, std::ost
         else if (request.AsMap().at("type").AsString() == "Route") {
             ProceedRouteRequest(request_handler, responses, request);
         }
+        else if (request.AsMap().at("type").AsString() == "RouteMatrix") {
+            ProceedRouteMatrixRequest(request_handler, responses, request);
+        }
     }
 
     responses.EndArray();
@@ -43,10 +43,15 @@ private:
     void ParseBus(json::Dict dict);
     void Print(json::Document& doc, std::ostream& out) const;
     std::vector<svg::Color> MakeColorPalette(json::Array colors) const;
+    RouterType ParseRouterType(std::string_view name) const;
+    WarmUpMode ParseWarmUpMode(std::string_view name) const;
+    GraphModel ParseGraphModel(std::string_view name) const;
+    size_t ParseCount(std::string_view name, const json::Node& value) const;
     void ProceedBusRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const;
     void ProceedStopRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const;
     void ProceedMapRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const;
     void ProceedRouteRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const;
+    void ProceedRouteMatrixRequest(const RequestHandler& request_handler, json::Builder& responses, const json::Node& request) const;
 
     std::vector<Stop> stops_buffer_;
     std::vector<BusBuffer> buses_buffer_;
@@ -54,6 +59,7 @@ private:
     json::Array stat_requests_;
     json::Dict render_settings_;
     json::Dict routing_settings_;
+    json::Dict serialization_settings_;
 };
 
 } // namespace json_reader
\ No newline at end of file
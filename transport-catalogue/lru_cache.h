@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+// Потокобезопасный кэш ограниченного размера, вытесняет давно не использованные значения.
+// Размер кэша - сумма стоимостей значений; по умолчанию каждое значение стоит 1,
+// а если передавать размер значения в байтах, ёмкость становится бюджетом памяти
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : capacity_(capacity) {
+    }
+
+    std::optional<Value> Get(const Key& key) {
+        std::lock_guard guard(mutex_);
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        ++stats_.hits;
+        items_.splice(items_.begin(), items_, it->second);
+        return it->second->value;
+    }
+
+    // значение дороже всей ёмкости не кэшируется
+    void Put(const Key& key, Value value, size_t cost = 1) {
+        if (cost > capacity_) {
+            return;
+        }
+        std::lock_guard guard(mutex_);
+        if (const auto it = index_.find(key); it != index_.end()) {
+            size_ -= it->second->cost;
+            items_.erase(it->second);
+            index_.erase(it);
+        }
+        while (size_ + cost > capacity_) {
+            size_ -= items_.back().cost;
+            index_.erase(items_.back().key);
+            items_.pop_back();
+            ++stats_.evictions;
+        }
+        items_.push_front({ key, std::move(value), cost });
+        index_[key] = items_.begin();
+        size_ += cost;
+    }
+
+    void Clear() {
+        std::lock_guard guard(mutex_);
+        items_.clear();
+        index_.clear();
+        size_ = 0;
+    }
+
+    size_t GetCapacity() const {
+        return capacity_;
+    }
+
+    CacheStats GetStats() const {
+        std::lock_guard guard(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Item {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+    using Items = std::list<Item>;
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    Items items_; // от недавно использованных к давно не использованным
+    std::unordered_map<Key, typename Items::iterator, Hash> index_;
+    size_t size_ = 0; // сумма стоимостей значений
+    CacheStats stats_;
+};
+
+} // namespace cache
\ No newline at end of file
@@ -3,10 +3,11 @@
 #include "map_renderer.h"
 #include "request_handler.h"
 #include "transport_router.h"
-//#include "tests.h"
+#include "tests.h"
 
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
 using namespace std;
 using namespace transport_catalogue;
@@ -14,8 +15,12 @@ using namespace json_reader;
 using namespace renderer;
 using namespace router;
 
-int main() {
-    //RunTests();
+int main(int argc, char* argv[]) {
+    // с ключом --tests вместо обработки запросов запускаются проверки движков маршрутов
+    if (argc > 1 && argv[1] == "--tests"sv) {
+        RunTests();
+        return 0;
+    }
 
     JsonReader reader;
     reader.ReadInput(cin);
@@ -6,9 +6,11 @@
 
 #include "map_renderer.h"
 
+#include <algorithm>
 #include <cmath>
-#include <map>
+#include <iterator>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <variant>
 
@@ -101,14 +103,9 @@ void MapRenderer::SetColorPalette(std::vector<svg::Color> color_palette) {
     color_palette_ = color_palette;
 }
 
-svg::Document MapRenderer::PrintMap(BusesTable buses_table) const {
-    std::map<std::string_view, Bus*> sorted_buses_table;
-    for (const auto& bus : buses_table) {
-        sorted_buses_table.insert(bus);
-    }
-
+svg::Document MapRenderer::PrintMap(SortedBuses buses) const {
     std::vector<geo::Coordinates> all_points;
-    for (const auto& [_, bus] : sorted_buses_table) {
+    for (const Bus* bus : buses) {
         for (const auto& stop : bus->stops) {
             all_points.push_back(stop->coordinates);
         }
@@ -122,7 +119,7 @@ svg::Document MapRenderer::PrintMap(BusesTable buses_table) const {
 
     {
         auto color_it = color_palette_.begin();
-        for (const auto& [_, bus] : sorted_buses_table) {
+        for (const Bus* bus : buses) {
             if (bus->stops.empty()) {
                 continue;
             }
@@ -149,7 +146,7 @@ svg::Document MapRenderer::PrintMap(BusesTable buses_table) const {
 
     {
         auto color_it = color_palette_.begin();
-        for (const auto& [_, bus] : sorted_buses_table) {
+        for (const Bus* bus : buses) {
             if (bus->stops.empty()) {
                 continue;
             }
@@ -200,21 +197,19 @@ svg::Document MapRenderer::PrintMap(BusesTable buses_table) const {
     {
         // создаем уникальные и упорядоченные остановки
 
-        std::map<std::string_view, Stop*> sorted_stops;
-
-        for (const auto& [_, bus] : sorted_buses_table) {
-            if (bus->stops.empty()) {
-                continue;
-            }
+        std::vector<const Stop*> sorted_stops;
 
-            for (const auto& stop : bus->stops) {
-                sorted_stops.insert({ stop->name, stop });
-            }
+        for (const Bus* bus : buses) {
+            sorted_stops.insert(sorted_stops.end(), bus->stops.begin(), bus->stops.end());
         }
+        std::sort(sorted_stops.begin(), sorted_stops.end(), [](const Stop* lhs, const Stop* rhs) {
+            return lhs->name < rhs->name;
+        });
+        sorted_stops.erase(std::unique(sorted_stops.begin(), sorted_stops.end()), sorted_stops.end());
 
         // Кружочки остановок
 
-        for (const auto& [_, stop] : sorted_stops) {
+        for (const Stop* stop : sorted_stops) {
             svg::Circle circle;
             circle.SetCenter(projector(stop->coordinates)).SetRadius(stop_radius_).SetFillColor("white");
             doc.Add(circle);
@@ -222,7 +217,7 @@ svg::Document MapRenderer::PrintMap(BusesTable buses_table) const {
 
         // Текст остановок
 
-        for (const auto& [_, stop] : sorted_stops) {
+        for (const Stop* stop : sorted_stops) {
             svg::Text stop_label;
             svg::Text stop_label_underlayer;
             stop_label.SetPosition(projector(stop->coordinates)).SetOffset(stop_label_offset_)
@@ -118,7 +118,8 @@ public:
     void SetUnderlayerWidth(double underlayer_width);
     void SetColorPalette(std::vector<svg::Color> color_palette);
 
-    svg::Document PrintMap(BusesTable buses_table) const;
+    // автобусы должны быть упорядочены по названию, от порядка зависят цвета линий
+    svg::Document PrintMap(SortedBuses buses) const;
 
 private:
     double width_ = 1200.0;
@@ -0,0 +1,177 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace parallel {
+
+// 0 означает "все аппаратные потоки"
+inline size_t GetThreadCount(size_t requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Кусок номер part из parts почти равных непрерывных кусков [0, count)
+inline std::pair<size_t, size_t> GetChunk(size_t count, size_t parts, size_t part) {
+    const size_t chunk_size = count / parts;
+    const size_t remainder = count % parts;
+    const size_t begin = part * chunk_size + std::min(part, remainder);
+    return { begin, begin + chunk_size + (part < remainder ? 1 : 0) };
+}
+
+// Делит [0, count) на непрерывные куски и вызывает func(begin, end) для каждого куска
+// в отдельном потоке. Исключения из потоков пробрасываются вызывающему
+template <typename Func>
+void ForEachChunk(size_t count, size_t thread_count, const Func& func) {
+    thread_count = std::min(std::max<size_t>(thread_count, 1), count);
+    if (thread_count <= 1) {
+        if (count > 0) {
+            func(size_t{ 0 }, count);
+        }
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(thread_count - 1);
+    for (size_t thread = 0; thread + 1 < thread_count; ++thread) {
+        const auto [begin, end] = GetChunk(count, thread_count, thread);
+        futures.push_back(std::async(std::launch::async, [&func, begin = begin, end = end] { func(begin, end); }));
+    }
+    const auto [begin, end] = GetChunk(count, thread_count, thread_count - 1);
+    func(begin, end);
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+// Рабочие потоки для многих вызовов ForEachChunk подряд: потоки создаются один раз,
+// а каждый вызов только раздаёт им куски и ждёт, пока все закончат.
+// Вызывающий поток обрабатывает последний кусок сам
+class ChunkWorkers {
+public:
+    // thread_count - число потоков вместе с вызывающим. Больше max_chunk_count кусков ни один вызов
+    // не раздаёт, поэтому лишние потоки не создаются
+    ChunkWorkers(size_t thread_count, size_t max_chunk_count) {
+        thread_count = std::min(thread_count, max_chunk_count);
+        for (size_t worker = 0; worker + 1 < thread_count; ++worker) {
+            threads_.emplace_back([this, worker] { Run(worker); });
+        }
+    }
+
+    ChunkWorkers(const ChunkWorkers&) = delete;
+    ChunkWorkers& operator=(const ChunkWorkers&) = delete;
+
+    ~ChunkWorkers() {
+        {
+            std::lock_guard guard(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    template <typename Func>
+    void ForEachChunk(size_t count, const Func& func) {
+        const size_t parts = std::min(threads_.size() + 1, count);
+        if (parts <= 1) {
+            if (count > 0) {
+                func(size_t{ 0 }, count);
+            }
+            return;
+        }
+
+        const std::function<void(size_t, size_t)> task = [&func](size_t begin, size_t end) { func(begin, end); };
+        {
+            std::lock_guard guard(mutex_);
+            task_ = &task;
+            count_ = count;
+            parts_ = parts;
+            pending_ = threads_.size();
+            error_ = nullptr;
+            ++phase_;
+        }
+        start_.notify_all();
+
+        std::exception_ptr error;
+        try {
+            const auto [begin, end] = GetChunk(count, parts, parts - 1);
+            func(begin, end);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        task_ = nullptr;
+        if (!error) {
+            error = error_;
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void Run(size_t worker) {
+        uint64_t seen_phase = 0;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            start_.wait(lock, [&] { return stopping_ || phase_ != seen_phase; });
+            if (stopping_) {
+                return;
+            }
+            seen_phase = phase_;
+            const auto* task = task_;
+            const size_t count = count_;
+            const size_t parts = parts_;
+            lock.unlock();
+
+            std::exception_ptr error;
+            if (worker + 1 < parts) {
+                try {
+                    const auto [begin, end] = GetChunk(count, parts, worker);
+                    (*task)(begin, end);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    uint64_t phase_ = 0;
+    bool stopping_ = false;
+    const std::function<void(size_t, size_t)>* task_ = nullptr;
+    size_t count_ = 0;
+    size_t parts_ = 0;
+    size_t pending_ = 0; // рабочие потоки, ещё не закончившие текущий вызов
+    std::exception_ptr error_;
+};
+
+} // namespace parallel
\ No newline at end of file
@@ -12,6 +12,7 @@ class Range {
 public:
     using ValueType = typename std::iterator_traits<It>::value_type;
 
+    Range() = default;
     Range(It begin, It end)
         : begin_(begin)
         , end_(end) {
@@ -24,8 +25,8 @@ public:
     }
 
 private:
-    It begin_;
-    It end_;
+    It begin_{};
+    It end_{};
 };
 
 template <typename C>
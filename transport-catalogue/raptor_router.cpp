@@ -0,0 +1,185 @@
+﻿#include "raptor_router.h"
+
+#include "transport_router.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace router {
+
+namespace {
+
+const double INFINITE_TIME = std::numeric_limits<double>::infinity();
+const uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+RaptorRouter::RaptorRouter(const RoutingSettings& settings, const transport_catalogue::TransportCatalogue& catalogue)
+    : settings_(settings)
+    , catalogue_(catalogue) {
+    for (StopId stop = 0; stop < catalogue.GetStopCount(); ++stop) {
+        stop_names_.push_back(catalogue.GetStopName(stop));
+    }
+
+    // круговой автобус даёт одно направление, некруговой - два: до конечной и обратно
+    // (как и в графе, обратное направление считается по обратным расстояниям первой половины)
+    std::vector<StopId> stops;
+    std::vector<int64_t> distances;
+    for (BusId bus = 0; bus < catalogue.GetBusCount(); ++bus) {
+        const Bus& bus_info = catalogue.GetBus(bus);
+        const auto& bus_stops = bus_info.stops;
+        if (bus_stops.size() < 2) {
+            continue;
+        }
+        const size_t last = bus_info.is_round ? bus_stops.size() - 1 : bus_stops.size() / 2;
+
+        stops.assign(1, bus_stops[0]->id);
+        distances.assign(1, 0);
+        for (size_t k = 1; k <= last; ++k) {
+            stops.push_back(bus_stops[k]->id);
+            distances.push_back(distances.back() + catalogue.GetDistance(bus_stops[k - 1], bus_stops[k]));
+        }
+        AddLine(bus_info.name, stops, distances);
+
+        if (!bus_info.is_round) {
+            stops.assign(1, bus_stops[last]->id);
+            distances.assign(1, 0);
+            for (size_t k = last; k > 0; --k) {
+                stops.push_back(bus_stops[k - 1]->id);
+                distances.push_back(distances.back() + catalogue.GetDistance(bus_stops[k], bus_stops[k - 1]));
+            }
+            AddLine(bus_info.name, stops, distances);
+        }
+    }
+
+    stop_lines_offsets_.assign(stop_names_.size() + 1, 0);
+    for (const StopId stop : line_stops_) {
+        ++stop_lines_offsets_[stop + 1];
+    }
+    for (size_t stop = 0; stop < stop_names_.size(); ++stop) {
+        stop_lines_offsets_[stop + 1] += stop_lines_offsets_[stop];
+    }
+    stop_lines_.resize(line_stops_.size());
+    std::vector<size_t> filled(stop_lines_offsets_.begin(), stop_lines_offsets_.end() - 1);
+    for (uint32_t line = 0; line < lines_.size(); ++line) {
+        for (size_t position = lines_[line].begin; position < lines_[line].end; ++position) {
+            stop_lines_[filled[line_stops_[position]]++] = { line, static_cast<uint32_t>(position) };
+        }
+    }
+}
+
+void RaptorRouter::AddLine(std::string_view bus_name, const std::vector<StopId>& stops,
+    const std::vector<int64_t>& distances) {
+    lines_.push_back({ bus_name, line_stops_.size(), line_stops_.size() + stops.size() });
+    line_stops_.insert(line_stops_.end(), stops.begin(), stops.end());
+    line_distances_.insert(line_distances_.end(), distances.begin(), distances.end());
+}
+
+double RaptorRouter::ComputeRideTime(size_t board_position, size_t alight_position) const {
+    // то же выражение, что и для веса ребра графа, чтобы время совпадало до бита
+    const double stops_distance = static_cast<double>(line_distances_[alight_position]
+        - line_distances_[board_position]);
+    return stops_distance / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR;
+}
+
+RaptorRouter::SearchResult RaptorRouter::Search(StopId stop_from) const {
+    std::vector<double> times(stop_names_.size(), INFINITE_TIME);
+    std::vector<Arrival> arrivals(stop_names_.size(), { 0, NO_POSITION, NO_POSITION });
+    std::vector<bool> marked(stop_names_.size(), false);
+    std::vector<uint32_t> first_positions(lines_.size(), NO_POSITION);
+    std::vector<StopId> marked_stops = { stop_from };
+    std::vector<uint32_t> queued_lines;
+    times[stop_from] = 0;
+
+    while (!marked_stops.empty()) {
+        // направления, которые стоит просмотреть, с самой ранней улучшенной остановки
+        for (const StopId stop : marked_stops) {
+            marked[stop] = false;
+            for (size_t i = stop_lines_offsets_[stop]; i < stop_lines_offsets_[stop + 1]; ++i) {
+                const auto [line, position] = stop_lines_[i];
+                if (first_positions[line] == NO_POSITION) {
+                    queued_lines.push_back(line);
+                }
+                first_positions[line] = std::min(first_positions[line], position);
+            }
+        }
+        marked_stops.clear();
+
+        for (const uint32_t line : queued_lines) {
+            bool boarded = false;
+            uint32_t board_position = 0;
+            double board_time = 0;
+            for (uint32_t position = first_positions[line]; position < lines_[line].end; ++position) {
+                const StopId stop = line_stops_[position];
+                double ride_time = 0;
+                if (boarded) {
+                    ride_time = ComputeRideTime(board_position, position);
+                    const double time = board_time + settings_.bus_wait_time + ride_time;
+                    if (time < times[stop]) {
+                        times[stop] = time;
+                        arrivals[stop] = { line, board_position, position };
+                        if (!marked[stop]) {
+                            marked[stop] = true;
+                            marked_stops.push_back(stop);
+                        }
+                    }
+                }
+                // пересаживаться на этот же автобус выгодно, только если сюда можно добраться быстрее
+                if (times[stop] != INFINITE_TIME && (!boarded || times[stop] < board_time + ride_time)) {
+                    boarded = true;
+                    board_position = position;
+                    board_time = times[stop];
+                }
+            }
+            first_positions[line] = NO_POSITION;
+        }
+        queued_lines.clear();
+    }
+
+    return { std::move(times), std::move(arrivals) };
+}
+
+std::optional<RouteResponse> RaptorRouter::BuildRoute(std::string_view from, std::string_view to) const {
+    const StopId stop_from = catalogue_.FindStopId(from);
+    const StopId stop_to = catalogue_.FindStopId(to);
+    const auto [times, arrivals] = Search(stop_from);
+
+    if (times[stop_to] == INFINITE_TIME) {
+        return std::nullopt;
+    }
+    RouteResponse response;
+    response.total_time = times[stop_to];
+    for (StopId stop = stop_to; stop != stop_from;) {
+        const Arrival& arrival = arrivals[stop];
+        response.time_cuts.push_back(RidingBus{
+            /*time*/ ComputeRideTime(arrival.board_position, arrival.alight_position),
+            /*bus_name*/ lines_[arrival.line].bus_name,
+            /*span_count*/ arrival.alight_position - arrival.board_position });
+        stop = line_stops_[arrival.board_position];
+        response.time_cuts.push_back(Wait{ settings_.bus_wait_time, stop_names_[stop] });
+    }
+    std::reverse(response.time_cuts.begin(), response.time_cuts.end());
+
+    return response;
+}
+
+std::vector<std::optional<double>> RaptorRouter::BuildTimes(std::string_view from,
+    const std::vector<std::string_view>& to) const {
+    const StopId stop_from = catalogue_.FindStopId(from);
+    std::vector<StopId> stops_to;
+    stops_to.reserve(to.size());
+    for (const auto stop_name : to) {
+        stops_to.push_back(catalogue_.FindStopId(stop_name));
+    }
+    const std::vector<double> times = Search(stop_from).times;
+
+    std::vector<std::optional<double>> result;
+    result.reserve(to.size());
+    for (const StopId stop_to : stops_to) {
+        result.push_back(times[stop_to] == INFINITE_TIME ? std::nullopt : std::optional<double>(times[stop_to]));
+    }
+    return result;
+}
+
+} // namespace router
\ No newline at end of file
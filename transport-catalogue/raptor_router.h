@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "domain.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace router {
+
+// Поиск маршрутов по раундам (RAPTOR) прямо по последовательностям остановок автобусов,
+// без графа из всех пар остановок. Каждый раунд просматривает маршруты, проходящие через
+// остановки, улучшенные в прошлом раунде. Время ожидания и скорость те же, что и в графе,
+// поэтому ответы совпадают с ответами остальных маршрутизаторов
+class RaptorRouter {
+public:
+    RaptorRouter(const RoutingSettings& settings, const transport_catalogue::TransportCatalogue& catalogue);
+
+    std::optional<RouteResponse> BuildRoute(std::string_view from, std::string_view to) const;
+    // время в пути из одной остановки до каждой из остановок to за один поиск
+    std::vector<std::optional<double>> BuildTimes(std::string_view from, const std::vector<std::string_view>& to) const;
+
+private:
+    // Направление автобуса: остановки и накопленные расстояния лежат в общих массивах
+    struct Line {
+        std::string_view bus_name;
+        size_t begin;
+        size_t end;
+    };
+
+    struct LineStop {
+        uint32_t line;
+        uint32_t position;
+    };
+
+    // Как остановка была достигнута: на каком направлении, где села и где вышла
+    struct Arrival {
+        uint32_t line;
+        uint32_t board_position;
+        uint32_t alight_position;
+    };
+
+    struct SearchResult {
+        std::vector<double> times;
+        std::vector<Arrival> arrivals;
+    };
+
+    SearchResult Search(StopId stop_from) const;
+    void AddLine(std::string_view bus_name, const std::vector<StopId>& stops, const std::vector<int64_t>& distances);
+    double ComputeRideTime(size_t board_position, size_t alight_position) const;
+
+    RoutingSettings settings_;
+    const transport_catalogue::TransportCatalogue& catalogue_;
+
+    // остановки нумеруются номерами справочника
+    std::vector<std::string_view> stop_names_;
+
+    std::vector<Line> lines_;
+    std::vector<StopId> line_stops_;
+    std::vector<int64_t> line_distances_;
+
+    // направления, проходящие через каждую остановку, в формате CSR
+    std::vector<size_t> stop_lines_offsets_;
+    std::vector<LineStop> stop_lines_;
+};
+
+} // namespace router
\ No newline at end of file
@@ -20,8 +20,13 @@ std::optional<RouteResponse> RequestHandler::GetRoute(std::string_view from, std
     return router_.GetRoute(from, to);
 }
 
-BusesTable RequestHandler::GetAllBuses() const {
-    return db_.GetAllBuses();
+TravelTimeMatrix RequestHandler::GetTravelTimes(const std::vector<std::string_view>& from,
+    const std::vector<std::string_view>& to) const {
+    return router_.GetTravelTimes(from, to);
+}
+
+SortedBuses RequestHandler::GetAllBuses() const {
+    return db_.GetSortedBuses();
 }
 
 svg::Document RequestHandler::RenderMap() const {
@@ -20,6 +20,8 @@
 #include "transport_router.h"
 
 #include <optional>
+#include <string_view>
+#include <vector>
  
 class RequestHandler {
 public:
@@ -33,7 +35,9 @@ public:
     BusResponse GetBusInfo(std::string_view bus_name) const;
     StopResponse GetStopInfo(std::string_view stop_name) const;
     std::optional<RouteResponse> GetRoute(std::string_view from, std::string_view to) const;
-    BusesTable GetAllBuses() const;
+    TravelTimeMatrix GetTravelTimes(const std::vector<std::string_view>& from,
+        const std::vector<std::string_view>& to) const;
+    SortedBuses GetAllBuses() const;
     svg::Document RenderMap() const;
 
 private:
@@ -1,13 +1,19 @@
 #pragma once
 
+#include "flat_buffer.h"
 #include "graph.h"
+#include "parallel.h"
+#include "router_kernels.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -15,103 +21,284 @@
 namespace graph {
 
 template <typename Weight>
-class Router {
+struct RouteInfo {
+    Weight weight;
+    std::vector<EdgeId> edges;
+};
+
+template <typename Weight>
+class RoutingEngine {
+public:
+    virtual ~RoutingEngine() = default;
+
+    virtual std::optional<RouteInfo<Weight>> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // веса маршрутов из одной вершины во все вершины to; движки, которые умеют
+    // искать сразу до многих вершин, переопределяют этот метод
+    virtual std::vector<std::optional<Weight>> BuildWeights(VertexId from, const std::vector<VertexId>& to) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(to.size());
+        for (const VertexId vertex_to : to) {
+            const auto route = BuildRoute(from, vertex_to);
+            weights.push_back(route ? std::optional<Weight>(route->weight) : std::nullopt);
+        }
+        return weights;
+    }
+};
+
+// Веса из одного uint32_t с насыщающим сложением, таблица маршрутов релаксирует их
+// векторным ядром для uint32_t
+template <typename Weight>
+struct IsSaturatingUint32Weight : std::false_type {};
+
+struct RoutesTableSettings {
+    bool use_huge_pages = false;
+    size_t thread_count = 1; // 0 means all hardware threads
+};
+
+template <typename Weight>
+class Router : public RoutingEngine<Weight> {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    using PrevEdge = uint32_t;
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
-    };
+    explicit Router(const Graph& graph, RoutesTableSettings settings = {});
+    // маршрутизатор по готовой таблице маршрутов, например загруженной из снимка
+    Router(const Graph& graph, FlatBuffer<Weight> weights, FlatBuffer<PrevEdge> prev_edges);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+    const FlatBuffer<Weight>& GetWeights() const {
+        return weights_;
+    }
+    const FlatBuffer<PrevEdge>& GetPrevEdges() const {
+        return prev_edges_;
+    }
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    size_t GetIndex(VertexId vertex_from, VertexId vertex_to) const {
+        return vertex_from * vertex_count_ + vertex_to;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ ZERO_WEIGHT, std::nullopt };
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            weights_[GetIndex(vertex, vertex)] = ZERO_WEIGHT;
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                 const auto& edge = graph.GetEdge(edge_id);
                 if (edge.weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{ edge.weight, edge_id };
+                const size_t index = GetIndex(vertex, edge.to);
+                if (weights_[index] > edge.weight) {
+                    weights_[index] = edge.weight;
+                    prev_edges_[index] = static_cast<PrevEdge>(edge_id);
                 }
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-        const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = { candidate_weight,
-                                route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge };
+    void RelaxRow(VertexId vertex_from, Weight weight_from, PrevEdge prev_edge_from,
+        const Weight* weights_through, const PrevEdge* prev_edges_through,
+        size_t vertex_to_begin, size_t vertex_to_end) {
+        Weight* weights_relaxing = weights_.Data() + GetIndex(vertex_from, 0);
+        PrevEdge* prev_edges_relaxing = prev_edges_.Data() + GetIndex(vertex_from, 0);
+        if constexpr (std::is_same_v<Weight, double>) {
+            graph::RelaxRow(weights_relaxing + vertex_to_begin, prev_edges_relaxing + vertex_to_begin, weight_from,
+                prev_edge_from, weights_through + vertex_to_begin, prev_edges_through + vertex_to_begin,
+                vertex_to_end - vertex_to_begin);
+        }
+        else if constexpr (IsSaturatingUint32Weight<Weight>::value) {
+            static_assert(sizeof(Weight) == sizeof(uint32_t) && std::is_trivially_copyable_v<Weight>);
+            graph::RelaxRow(reinterpret_cast<uint32_t*>(weights_relaxing + vertex_to_begin),
+                prev_edges_relaxing + vertex_to_begin, reinterpret_cast<const uint32_t&>(weight_from),
+                prev_edge_from, reinterpret_cast<const uint32_t*>(weights_through + vertex_to_begin),
+                prev_edges_through + vertex_to_begin, vertex_to_end - vertex_to_begin);
+        }
+        else {
+            for (VertexId vertex_to = vertex_to_begin; vertex_to < vertex_to_end; ++vertex_to) {
+                if (weights_through[vertex_to] == INFINITE_WEIGHT) {
+                    continue;
+                }
+                const Weight candidate_weight = weight_from + weights_through[vertex_to];
+                if (candidate_weight < weights_relaxing[vertex_to]) {
+                    weights_relaxing[vertex_to] = candidate_weight;
+                    prev_edges_relaxing[vertex_to] = prev_edges_through[vertex_to] != NO_EDGE
+                        ? prev_edges_through[vertex_to] : prev_edge_from;
+                }
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
-                }
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_through, size_t vertex_from_begin,
+        size_t vertex_from_end) {
+        const Weight* weights_through = weights_.Data() + GetIndex(vertex_through, 0);
+        const PrevEdge* prev_edges_through = prev_edges_.Data() + GetIndex(vertex_through, 0);
+        for (VertexId vertex_from = vertex_from_begin; vertex_from < vertex_from_end; ++vertex_from) {
+            const size_t index_from = GetIndex(vertex_from, vertex_through);
+            if (weights_[index_from] != INFINITE_WEIGHT) {
+                RelaxRow(vertex_from, weights_[index_from], prev_edges_[index_from],
+                    weights_through, prev_edges_through, 0, vertex_count_);
             }
         }
     }
 
+    void RelaxRoutesInternalDataThroughBlock(VertexId block_begin, VertexId block_end, parallel::ChunkWorkers& workers);
+    void RelaxRowThroughBlock(VertexId vertex_from, VertexId block_begin, VertexId block_end,
+        const Weight* block_weights, const PrevEdge* block_prev_edges);
+
+    static constexpr size_t BLOCK_SIZE = 32;
+    static constexpr size_t TILE_SIZE = 512;
     static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+        ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+    static constexpr PrevEdge NO_EDGE = NO_PREV_EDGE;
+
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    size_t vertex_count_;
+    // таблица всех маршрутов хранится построчно: веса отдельно от последних рёбер маршрутов
+    FlatBuffer<Weight> weights_;
+    FlatBuffer<PrevEdge> prev_edges_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, RoutesTableSettings settings)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-        std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
 {
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for the routes table");
+    }
+    weights_ = FlatBuffer<Weight>(vertex_count_ * vertex_count_, INFINITE_WEIGHT, settings.use_huge_pages);
+    prev_edges_ = FlatBuffer<PrevEdge>(vertex_count_ * vertex_count_, NO_EDGE, settings.use_huge_pages);
+
     InitializeRoutesInternalData(graph);
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    // потоки создаются один раз на всё построение, а не на каждый блок промежуточных вершин
+    parallel::ChunkWorkers workers(parallel::GetThreadCount(settings.thread_count), vertex_count_);
+    for (VertexId block_begin = 0; block_begin < vertex_count_; block_begin += BLOCK_SIZE) {
+        RelaxRoutesInternalDataThroughBlock(block_begin, std::min(block_begin + BLOCK_SIZE, vertex_count_),
+            workers);
+    }
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, FlatBuffer<Weight> weights, FlatBuffer<PrevEdge> prev_edges)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , weights_(std::move(weights))
+    , prev_edges_(std::move(prev_edges))
+{
+    if (weights_.Size() != vertex_count_ * vertex_count_ || prev_edges_.Size() != vertex_count_ * vertex_count_) {
+        throw std::invalid_argument("Routes table doesn't match the graph");
+    }
+}
+
+// Шаги алгоритма Флойда-Уоршелла для промежуточных вершин [block_begin, block_end).
+// Каждая ячейка таблицы проходит через те же шаги и в том же порядке, что и в
+// последовательной версии, поэтому результат совпадает с ней побитово.
+template <typename Weight>
+void Router<Weight>::RelaxRoutesInternalDataThroughBlock(VertexId block_begin, VertexId block_end,
+    parallel::ChunkWorkers& workers) {
+    // Строки самих промежуточных вершин обрабатываются последовательно. Строка vertex_through
+    // на шаге vertex_through не меняется, её копия после этого шага и нужна остальным строкам
+    const size_t block_size = block_end - block_begin;
+    std::vector<Weight> block_weights(block_size * vertex_count_);
+    std::vector<PrevEdge> block_prev_edges(block_size * vertex_count_);
+    for (VertexId vertex_through = block_begin; vertex_through < block_end; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_through, block_begin, block_end);
+        const size_t offset = (vertex_through - block_begin) * vertex_count_;
+        std::copy_n(weights_.Data() + GetIndex(vertex_through, 0), vertex_count_, block_weights.begin() + offset);
+        std::copy_n(prev_edges_.Data() + GetIndex(vertex_through, 0), vertex_count_,
+            block_prev_edges.begin() + offset);
     }
+
+    // Остальные строки независимы друг от друга
+    const size_t other_rows_count = vertex_count_ - block_size;
+    workers.ForEachChunk(other_rows_count, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            const VertexId vertex_from = row < block_begin ? row : row + block_size;
+            RelaxRowThroughBlock(vertex_from, block_begin, block_end, block_weights.data(), block_prev_edges.data());
+        }
+    });
+}
+
+template <typename Weight>
+void Router<Weight>::RelaxRowThroughBlock(VertexId vertex_from, VertexId block_begin, VertexId block_end,
+    const Weight* block_weights, const PrevEdge* block_prev_edges) {
+    const size_t block_size = block_end - block_begin;
+
+    // Сначала столбцы самого блока: заодно запоминаем, каким был маршрут
+    // до каждой промежуточной вершины на её шаге
+    std::array<Weight, BLOCK_SIZE> weights_from;
+    std::array<PrevEdge, BLOCK_SIZE> prev_edges_from;
+    for (size_t step = 0; step < block_size; ++step) {
+        const size_t index_from = GetIndex(vertex_from, block_begin + step);
+        weights_from[step] = weights_[index_from];
+        prev_edges_from[step] = prev_edges_[index_from];
+        if (weights_from[step] != INFINITE_WEIGHT) {
+            RelaxRow(vertex_from, weights_from[step], prev_edges_from[step], block_weights + step * vertex_count_,
+                block_prev_edges + step * vertex_count_, block_begin, block_end);
+        }
+    }
+
+    // Затем остальные столбцы полосами, которые вместе с частью блока помещаются в кэш
+    const auto relax_columns = [&](size_t columns_begin, size_t columns_end) {
+        for (size_t tile_begin = columns_begin; tile_begin < columns_end; tile_begin += TILE_SIZE) {
+            const size_t tile_end = std::min(tile_begin + TILE_SIZE, columns_end);
+            for (size_t step = 0; step < block_size; ++step) {
+                if (weights_from[step] != INFINITE_WEIGHT) {
+                    RelaxRow(vertex_from, weights_from[step], prev_edges_from[step],
+                        block_weights + step * vertex_count_, block_prev_edges + step * vertex_count_,
+                        tile_begin, tile_end);
+                }
+            }
+        }
+    };
+    relax_columns(0, block_begin);
+    relax_columns(block_end, vertex_count_);
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
     VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = weights_[GetIndex(from, to)];
+    if (weight == INFINITE_WEIGHT) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-        edge_id;
-        edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+    for (PrevEdge edge_id = prev_edges_[GetIndex(from, to)];
+        edge_id != NO_EDGE;
+        edge_id = prev_edges_[GetIndex(from, graph_.GetEdgeUnchecked(edge_id).from)])
     {
-        edges.push_back(*edge_id);
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
     return RouteInfo{ weight, std::move(edges) };
 }
 
+template <typename Weight>
+std::vector<std::optional<Weight>> Router<Weight>::BuildWeights(VertexId from,
+    const std::vector<VertexId>& to) const {
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        if (from >= vertex_count_ || vertex_to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const Weight weight = weights_[GetIndex(from, vertex_to)];
+        weights.push_back(weight == INFINITE_WEIGHT ? std::nullopt : std::optional<Weight>(weight));
+    }
+    return weights;
+}
+
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,218 @@
+﻿#include "router_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROUTER_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace {
+
+using RelaxRowKernel = void (*)(double*, uint32_t*, double, uint32_t, const double*, const uint32_t*, size_t);
+using RelaxRowKernelUint32 =
+    void (*)(uint32_t*, uint32_t*, uint32_t, uint32_t, const uint32_t*, const uint32_t*, size_t);
+
+inline constexpr uint32_t INFINITE_UINT32_WEIGHT = UINT32_MAX;
+
+} // namespace
+
+void RelaxRowScalar(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from,
+    uint32_t prev_edge_from, const double* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // для недостижимой вершины сумма равна бесконечности и проверку не пройдёт
+        const double candidate_weight = weight_from + weights_through[i];
+        if (candidate_weight < weights_relaxing[i]) {
+            weights_relaxing[i] = candidate_weight;
+            prev_edges_relaxing[i] = prev_edges_through[i] != NO_PREV_EDGE ? prev_edges_through[i] : prev_edge_from;
+        }
+    }
+}
+
+void RelaxRowScalar(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // переполнение даёт бесконечность, и проверку такая сумма не пройдёт
+        const uint32_t sum = weight_from + weights_through[i];
+        const uint32_t candidate_weight = sum < weight_from ? INFINITE_UINT32_WEIGHT : sum;
+        if (candidate_weight < weights_relaxing[i]) {
+            weights_relaxing[i] = candidate_weight;
+            prev_edges_relaxing[i] = prev_edges_through[i] != NO_PREV_EDGE ? prev_edges_through[i] : prev_edge_from;
+        }
+    }
+}
+
+namespace {
+
+#ifdef ROUTER_KERNELS_X86
+
+__attribute__((target("avx2")))
+void RelaxRowAvx2(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from,
+    uint32_t prev_edge_from, const double* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    const __m256d weight_from_vector = _mm256_set1_pd(weight_from);
+    const __m128i prev_edge_from_vector = _mm_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m128i no_prev_edge_vector = _mm_set1_epi32(static_cast<int>(NO_PREV_EDGE));
+    // младшие половины 64-битных масок сравнения -> 32-битные маски
+    const __m256i mask_permutation = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d candidate_weights = _mm256_add_pd(weight_from_vector, _mm256_loadu_pd(weights_through + i));
+        const __m256d relaxing_weights = _mm256_loadu_pd(weights_relaxing + i);
+        const __m256d improved = _mm256_cmp_pd(candidate_weights, relaxing_weights, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(improved) == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(weights_relaxing + i, _mm256_blendv_pd(relaxing_weights, candidate_weights, improved));
+
+        const __m128i prev_edges_through_vector =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + i));
+        const __m128i new_prev_edges = _mm_blendv_epi8(prev_edges_through_vector, prev_edge_from_vector,
+            _mm_cmpeq_epi32(prev_edges_through_vector, no_prev_edge_vector));
+        const __m128i improved_32 = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(_mm256_castpd_si256(improved), mask_permutation));
+        __m128i* prev_edges = reinterpret_cast<__m128i*>(prev_edges_relaxing + i);
+        _mm_storeu_si128(prev_edges, _mm_blendv_epi8(_mm_loadu_si128(prev_edges), new_prev_edges, improved_32));
+    }
+    RelaxRowScalar(weights_relaxing + i, prev_edges_relaxing + i, weight_from, prev_edge_from,
+        weights_through + i, prev_edges_through + i, count - i);
+}
+
+__attribute__((target("avx512f,avx512vl")))
+void RelaxRowAvx512(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from,
+    uint32_t prev_edge_from, const double* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    const __m512d weight_from_vector = _mm512_set1_pd(weight_from);
+    const __m256i prev_edge_from_vector = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i no_prev_edge_vector = _mm256_set1_epi32(static_cast<int>(NO_PREV_EDGE));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m512d candidate_weights = _mm512_add_pd(weight_from_vector, _mm512_loadu_pd(weights_through + i));
+        const __mmask8 improved =
+            _mm512_cmp_pd_mask(candidate_weights, _mm512_loadu_pd(weights_relaxing + i), _CMP_LT_OQ);
+        if (improved == 0) {
+            continue;
+        }
+        _mm512_mask_storeu_pd(weights_relaxing + i, improved, candidate_weights);
+
+        const __m256i prev_edges_through_vector =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i));
+        const __m256i new_prev_edges = _mm256_mask_blend_epi32(
+            _mm256_cmpeq_epi32_mask(prev_edges_through_vector, no_prev_edge_vector),
+            prev_edges_through_vector, prev_edge_from_vector);
+        _mm256_mask_storeu_epi32(prev_edges_relaxing + i, improved, new_prev_edges);
+    }
+    RelaxRowScalar(weights_relaxing + i, prev_edges_relaxing + i, weight_from, prev_edge_from,
+        weights_through + i, prev_edges_through + i, count - i);
+}
+
+// в AVX2 нет беззнакового сравнения 32-битных чисел, поэтому a < b проверяется через min(a, b)
+__attribute__((target("avx2")))
+void RelaxRowAvx2Uint32(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    const __m256i weight_from_vector = _mm256_set1_epi32(static_cast<int>(weight_from));
+    const __m256i prev_edge_from_vector = _mm256_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m256i no_prev_edge_vector = _mm256_set1_epi32(static_cast<int>(NO_PREV_EDGE));
+    const __m256i all_ones = _mm256_set1_epi32(-1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i sums = _mm256_add_epi32(weight_from_vector,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights_through + i)));
+        // сумма без переполнения не меньше слагаемого, иначе все биты в единицы
+        const __m256i not_overflowed = _mm256_cmpeq_epi32(_mm256_min_epu32(sums, weight_from_vector),
+            weight_from_vector);
+        const __m256i candidate_weights = _mm256_or_si256(sums, _mm256_xor_si256(not_overflowed, all_ones));
+        __m256i* weights = reinterpret_cast<__m256i*>(weights_relaxing + i);
+        const __m256i relaxing_weights = _mm256_loadu_si256(weights);
+        const __m256i improved = _mm256_andnot_si256(_mm256_cmpeq_epi32(candidate_weights, relaxing_weights),
+            _mm256_cmpeq_epi32(_mm256_min_epu32(candidate_weights, relaxing_weights), candidate_weights));
+        if (_mm256_testz_si256(improved, improved)) {
+            continue;
+        }
+        _mm256_storeu_si256(weights, _mm256_blendv_epi8(relaxing_weights, candidate_weights, improved));
+
+        const __m256i prev_edges_through_vector =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + i));
+        const __m256i new_prev_edges = _mm256_blendv_epi8(prev_edges_through_vector, prev_edge_from_vector,
+            _mm256_cmpeq_epi32(prev_edges_through_vector, no_prev_edge_vector));
+        __m256i* prev_edges = reinterpret_cast<__m256i*>(prev_edges_relaxing + i);
+        _mm256_storeu_si256(prev_edges, _mm256_blendv_epi8(_mm256_loadu_si256(prev_edges), new_prev_edges, improved));
+    }
+    RelaxRowScalar(weights_relaxing + i, prev_edges_relaxing + i, weight_from, prev_edge_from,
+        weights_through + i, prev_edges_through + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void RelaxRowAvx512Uint32(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    const __m512i weight_from_vector = _mm512_set1_epi32(static_cast<int>(weight_from));
+    const __m512i prev_edge_from_vector = _mm512_set1_epi32(static_cast<int>(prev_edge_from));
+    const __m512i no_prev_edge_vector = _mm512_set1_epi32(static_cast<int>(NO_PREV_EDGE));
+    const __m512i infinite_weight_vector = _mm512_set1_epi32(static_cast<int>(INFINITE_UINT32_WEIGHT));
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i sums = _mm512_add_epi32(weight_from_vector, _mm512_loadu_si512(weights_through + i));
+        const __m512i candidate_weights = _mm512_mask_mov_epi32(sums,
+            _mm512_cmplt_epu32_mask(sums, weight_from_vector), infinite_weight_vector);
+        const __mmask16 improved = _mm512_cmplt_epu32_mask(candidate_weights, _mm512_loadu_si512(weights_relaxing + i));
+        if (improved == 0) {
+            continue;
+        }
+        _mm512_mask_storeu_epi32(weights_relaxing + i, improved, candidate_weights);
+
+        const __m512i prev_edges_through_vector = _mm512_loadu_si512(prev_edges_through + i);
+        const __m512i new_prev_edges = _mm512_mask_mov_epi32(prev_edges_through_vector,
+            _mm512_cmpeq_epi32_mask(prev_edges_through_vector, no_prev_edge_vector), prev_edge_from_vector);
+        _mm512_mask_storeu_epi32(prev_edges_relaxing + i, improved, new_prev_edges);
+    }
+    RelaxRowScalar(weights_relaxing + i, prev_edges_relaxing + i, weight_from, prev_edge_from,
+        weights_through + i, prev_edges_through + i, count - i);
+}
+
+#endif // ROUTER_KERNELS_X86
+
+RelaxRowKernel SelectRelaxRowKernel() {
+#ifdef ROUTER_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+        return RelaxRowAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return RelaxRowAvx2;
+    }
+#endif
+    return RelaxRowScalar;
+}
+
+RelaxRowKernelUint32 SelectRelaxRowKernelUint32() {
+#ifdef ROUTER_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return RelaxRowAvx512Uint32;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return RelaxRowAvx2Uint32;
+    }
+#endif
+    return RelaxRowScalar;
+}
+
+} // namespace
+
+void RelaxRow(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from, uint32_t prev_edge_from,
+    const double* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    static const RelaxRowKernel kernel = SelectRelaxRowKernel();
+    kernel(weights_relaxing, prev_edges_relaxing, weight_from, prev_edge_from, weights_through, prev_edges_through,
+        count);
+}
+
+void RelaxRow(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count) {
+    static const RelaxRowKernelUint32 kernel = SelectRelaxRowKernelUint32();
+    kernel(weights_relaxing, prev_edges_relaxing, weight_from, prev_edge_from, weights_through, prev_edges_through,
+        count);
+}
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+inline constexpr uint32_t NO_PREV_EDGE = UINT32_MAX;
+
+// Релаксация отрезка строки таблицы маршрутов через промежуточную вершину:
+// weights_relaxing[i] = min(weights_relaxing[i], weight_from + weights_through[i]),
+// при улучшении последним ребром маршрута становится последнее ребро второй части маршрута,
+// а если его нет, то prev_edge_from.
+// Реализация выбирается один раз по возможностям процессора (AVX-512, AVX2 или скалярная),
+// результаты всех реализаций совпадают побитово
+void RelaxRow(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from, uint32_t prev_edge_from,
+    const double* weights_through, const uint32_t* prev_edges_through, size_t count);
+
+// То же для целочисленных весов: сумма насыщается до UINT32_MAX, который означает недостижимость
+void RelaxRow(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count);
+
+// скалярные реализации, с ними тесты сверяют векторные
+void RelaxRowScalar(double* weights_relaxing, uint32_t* prev_edges_relaxing, double weight_from,
+    uint32_t prev_edge_from, const double* weights_through, const uint32_t* prev_edges_through, size_t count);
+void RelaxRowScalar(uint32_t* weights_relaxing, uint32_t* prev_edges_relaxing, uint32_t weight_from,
+    uint32_t prev_edge_from, const uint32_t* weights_through, const uint32_t* prev_edges_through, size_t count);
+
+} // namespace graph
\ No newline at end of file
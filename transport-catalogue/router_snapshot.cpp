@@ -0,0 +1,234 @@
+﻿#include "router_snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ROUTER_SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace router {
+
+namespace {
+
+const size_t SECTION_ALIGNMENT = 64;
+
+// FNV-1a
+class Hasher {
+public:
+    void Add(const void* data, size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ = (hash_ ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+
+    template <typename T>
+    void Add(const T& value) {
+        Add(&value, sizeof(value));
+    }
+
+    void Add(std::string_view value) {
+        Add(static_cast<uint64_t>(value.size()));
+        Add(value.data(), value.size());
+    }
+
+    uint64_t Get() const {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 14695981039346656037ULL;
+};
+
+} // namespace
+
+uint64_t ComputeRoutingHash(const transport_catalogue::TransportCatalogue& catalogue,
+    const RoutingSettings& settings) {
+    Hasher hasher;
+    hasher.Add(SNAPSHOT_VERSION);
+    hasher.Add(settings.bus_wait_time);
+    hasher.Add(settings.bus_velocity);
+    hasher.Add(static_cast<int>(settings.router_type));
+    hasher.Add(static_cast<int>(settings.graph_model));
+    hasher.Add(settings.prune_parallel_edges);
+    hasher.Add(settings.use_integer_weights);
+
+    // номера зависят от порядка загрузки, поэтому обходим справочник в порядке названий
+    for (const Stop* stop : catalogue.GetSortedStops()) {
+        hasher.Add(std::string_view(stop->name));
+        hasher.Add(stop->coordinates.latitude);
+        hasher.Add(stop->coordinates.longitude);
+    }
+
+    for (const Bus* bus : catalogue.GetSortedBuses()) {
+        hasher.Add(std::string_view(bus->name));
+        hasher.Add(bus->is_round);
+        hasher.Add(static_cast<uint64_t>(bus->stops.size()));
+        for (size_t i = 0; i < bus->stops.size(); ++i) {
+            hasher.Add(std::string_view(bus->stops[i]->name));
+            if (i > 0) {
+                hasher.Add(catalogue.GetDistance(bus->stops[i - 1], bus->stops[i]));
+                hasher.Add(catalogue.GetDistance(bus->stops[i], bus->stops[i - 1]));
+            }
+        }
+    }
+
+    return hasher.Get();
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path, uint64_t routing_hash, uint64_t vertex_count)
+    : path_(path)
+    , temporary_path_(path + ".tmp")
+    , out_(temporary_path_, std::ios::binary | std::ios::trunc)
+{
+    if (!out_) {
+        throw std::runtime_error("Can't create snapshot file " + temporary_path_);
+    }
+    header_.routing_hash = routing_hash;
+    header_.vertex_count = vertex_count;
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+}
+
+void SnapshotWriter::WriteBytes(SnapshotSection section, const char* data, size_t size) {
+    const auto position = static_cast<uint64_t>(out_.tellp());
+    const uint64_t offset = (position + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    for (uint64_t i = position; i < offset; ++i) {
+        out_.put('\0');
+    }
+    out_.write(data, static_cast<std::streamsize>(size));
+    header_.sections[static_cast<size_t>(section)] = { offset, size };
+}
+
+void SnapshotWriter::WriteStrings(SnapshotSection section, const std::vector<std::string_view>& strings) {
+    // [количество][длины...][символы...]
+    std::string bytes;
+    const auto append = [&bytes](uint64_t value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    append(strings.size());
+    for (const auto& string : strings) {
+        append(string.size());
+    }
+    for (const auto& string : strings) {
+        bytes.append(string);
+    }
+    WriteBytes(section, bytes.data(), bytes.size());
+}
+
+void SnapshotWriter::Commit() {
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Can't write snapshot file " + temporary_path_);
+    }
+    if (std::rename(temporary_path_.c_str(), path_.c_str()) != 0) {
+        throw std::runtime_error("Can't replace snapshot file " + path_);
+    }
+}
+
+SnapshotReader::SnapshotReader(const std::string& path) {
+#ifdef ROUTER_SNAPSHOT_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open snapshot file " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        throw std::runtime_error("Can't read snapshot file " + path);
+    }
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ > 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Can't map snapshot file " + path);
+        }
+        data_ = static_cast<const char*>(data);
+        mapped_ = true;
+    }
+    close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Can't open snapshot file " + path);
+    }
+    size_ = static_cast<size_t>(in.tellg());
+    buffer_.resize((size_ + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_));
+    data_ = reinterpret_cast<const char*>(buffer_.data());
+#endif
+    if (size_ >= sizeof(header_)) {
+        std::memcpy(&header_, data_, sizeof(header_));
+    }
+}
+
+SnapshotReader::~SnapshotReader() {
+#ifdef ROUTER_SNAPSHOT_MMAP
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+bool SnapshotReader::IsValid(uint64_t routing_hash) const {
+    if (size_ < sizeof(header_) || header_.magic != SNAPSHOT_MAGIC || header_.version != SNAPSHOT_VERSION
+        || header_.byte_order_mark != SNAPSHOT_BYTE_ORDER_MARK || header_.routing_hash != routing_hash) {
+        return false;
+    }
+    return std::all_of(header_.sections.begin(), header_.sections.end(), [this](const auto& section) {
+        return section[0] <= size_ && section[1] <= size_ - section[0];
+    });
+}
+
+const SnapshotHeader& SnapshotReader::GetHeader() const {
+    return header_;
+}
+
+std::pair<const char*, size_t> SnapshotReader::GetBytes(SnapshotSection section, size_t alignment) const {
+    const auto& [offset, size] = header_.sections.at(static_cast<size_t>(section));
+    if (offset > size_ || size > size_ - offset || offset % alignment != 0) {
+        throw std::runtime_error("Broken snapshot section");
+    }
+    return { data_ + offset, static_cast<size_t>(size) };
+}
+
+std::vector<std::string_view> SnapshotReader::GetStrings(SnapshotSection section) const {
+    const auto [data, size] = GetBytes(section, alignof(uint64_t));
+    const auto read_number = [data = data, size = size](size_t index) {
+        if ((index + 1) * sizeof(uint64_t) > size) {
+            throw std::runtime_error("Broken snapshot strings");
+        }
+        uint64_t value;
+        std::memcpy(&value, data + index * sizeof(uint64_t), sizeof(value));
+        return value;
+    };
+
+    const uint64_t count = read_number(0);
+    if (count > size / sizeof(uint64_t)) {
+        throw std::runtime_error("Broken snapshot strings");
+    }
+    std::vector<std::string_view> strings;
+    strings.reserve(count);
+    size_t position = (count + 1) * sizeof(uint64_t);
+    for (uint64_t i = 0; i < count; ++i) {
+        const uint64_t length = read_number(i + 1);
+        if (length > size - position) {
+            throw std::runtime_error("Broken snapshot strings");
+        }
+        strings.emplace_back(data + position, length);
+        position += length;
+    }
+    return strings;
+}
+
+} // namespace router
\ No newline at end of file
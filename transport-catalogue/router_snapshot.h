@@ -0,0 +1,129 @@
+﻿/*
+ * Бинарный снимок подготовленных данных маршрутизатора.
+ *
+ * Файл состоит из заголовка и секций, каждая секция выровнена на 64 байта, поэтому
+ * массивы из файла, отображённого в память, можно использовать без копирования.
+ * В заголовке хранится хеш справочника и настроек маршрутизации: снимок,
+ * построенный по другим данным, отвергается.
+ */
+
+#pragma once
+
+#include "domain.h"
+#include "ranges.h"
+#include "transport_catalogue.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace router {
+
+inline constexpr std::array<char, 8> SNAPSHOT_MAGIC = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0' };
+inline constexpr uint32_t SNAPSHOT_VERSION = 4;
+inline constexpr uint32_t SNAPSHOT_BYTE_ORDER_MARK = 0x01020304;
+
+enum class SnapshotSection {
+    STOP_NAMES,
+    STOP_VERTICES,
+    BUS_NAMES,
+    EDGES,
+    EDGE_ANNOTATIONS,
+    ROUTES_WEIGHTS,
+    ROUTES_PREV_EDGES,
+    COUNT,
+};
+
+struct SnapshotHeader {
+    std::array<char, 8> magic = SNAPSHOT_MAGIC;
+    uint32_t version = SNAPSHOT_VERSION;
+    uint32_t byte_order_mark = SNAPSHOT_BYTE_ORDER_MARK;
+    uint64_t routing_hash = 0;
+    uint64_t vertex_count = 0;
+    // смещение и размер в байтах для каждой секции
+    std::array<std::array<uint64_t, 2>, static_cast<size_t>(SnapshotSection::COUNT)> sections{};
+};
+
+struct SnapshotEdge {
+    uint64_t from;
+    uint64_t to;
+    double weight;
+};
+
+enum class SnapshotEdgeKind : uint32_t {
+    WAIT,
+    BUS,
+};
+
+struct SnapshotEdgeAnnotation {
+    SnapshotEdgeKind kind;
+    uint32_t name_index; // в STOP_NAMES для ожидания, в BUS_NAMES для поездки
+    uint64_t span_count;
+    double distance; // длина поездки в метрах
+};
+
+// Хеш всего, от чего зависят данные маршрутизатора: остановок, маршрутов, расстояний и настроек
+uint64_t ComputeRoutingHash(const transport_catalogue::TransportCatalogue& catalogue,
+    const RoutingSettings& settings);
+
+class SnapshotWriter {
+public:
+    SnapshotWriter(const std::string& path, uint64_t routing_hash, uint64_t vertex_count);
+
+    template <typename T>
+    void WriteSection(SnapshotSection section, const T* data, size_t count) {
+        WriteBytes(section, reinterpret_cast<const char*>(data), count * sizeof(T));
+    }
+    void WriteStrings(SnapshotSection section, const std::vector<std::string_view>& strings);
+
+    // дописывает заголовок и атомарно заменяет файл
+    void Commit();
+
+private:
+    void WriteBytes(SnapshotSection section, const char* data, size_t size);
+
+    std::string path_;
+    std::string temporary_path_;
+    std::ofstream out_;
+    SnapshotHeader header_;
+};
+
+// Снимок, отображённый в память только для чтения
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::string& path);
+    ~SnapshotReader();
+
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    bool IsValid(uint64_t routing_hash) const;
+    const SnapshotHeader& GetHeader() const;
+
+    template <typename T>
+    ranges::Range<const T*> GetSection(SnapshotSection section) const {
+        const auto [data, size] = GetBytes(section, alignof(T));
+        if (size % sizeof(T) != 0) {
+            throw std::runtime_error("Broken snapshot section");
+        }
+        const T* begin = reinterpret_cast<const T*>(data);
+        return { begin, begin + size / sizeof(T) };
+    }
+    std::vector<std::string_view> GetStrings(SnapshotSection section) const;
+
+private:
+    std::pair<const char*, size_t> GetBytes(SnapshotSection section, size_t alignment) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<uint64_t> buffer_; // если отображение файла в память недоступно
+    SnapshotHeader header_;
+};
+
+} // namespace router
\ No newline at end of file
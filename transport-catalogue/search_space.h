@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "graph.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace graph {
+
+// Состояния вершин для поиска, переиспользуемые между запросами одного потока.
+// Запоминаются вершины, состояние которых менялось, и следующий запрос сбрасывает только их,
+// поэтому короткий поиск не платит O(V) за выделение и заполнение массива
+template <typename State>
+class SearchSpace {
+public:
+    // готовит пространство к новому поиску в графе из vertex_count вершин
+    void Reset(size_t vertex_count) {
+        if (states_.size() != vertex_count) {
+            states_.assign(vertex_count, State{});
+            is_touched_.assign(vertex_count, false);
+            touched_.clear();
+            return;
+        }
+        for (const VertexId vertex : touched_) {
+            states_[vertex] = State{};
+            is_touched_[vertex] = false;
+        }
+        touched_.clear();
+    }
+
+    const State& operator[](VertexId vertex) const {
+        return states_[vertex];
+    }
+
+    // доступ на запись, вершина будет сброшена перед следующим поиском
+    State& Touch(VertexId vertex) {
+        if (!is_touched_[vertex]) {
+            is_touched_[vertex] = true;
+            touched_.push_back(vertex);
+        }
+        return states_[vertex];
+    }
+
+private:
+    std::vector<State> states_;
+    std::vector<bool> is_touched_;
+    std::vector<VertexId> touched_;
+};
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,165 @@
+﻿#pragma once
+
+#include "graph.h"
+#include "lru_cache.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дейкстра, которая строит полное дерево кратчайших путей из вершины отправления
+// и хранит недавно использованные деревья в кэше с бюджетом памяти в байтах.
+// Повторный запрос из той же вершины проходит только по рёбрам маршрута
+template <typename Weight>
+class ShortestPathTreeRouter : public RoutingEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    ShortestPathTreeRouter(const Graph& graph, size_t cache_bytes);
+
+    using RouteInfo = graph::RouteInfo<Weight>;
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+    std::vector<std::optional<Weight>> BuildWeights(VertexId from, const std::vector<VertexId>& to) const override;
+
+private:
+    using PrevEdge = uint32_t;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    // вес маршрута до каждой вершины и последнее ребро маршрута
+    struct Tree {
+        std::vector<Weight> weights;
+        std::vector<PrevEdge> prev_edges;
+
+        size_t GetBytes() const {
+            return sizeof(Tree) + weights.capacity() * sizeof(Weight) + prev_edges.capacity() * sizeof(PrevEdge);
+        }
+    };
+
+    std::shared_ptr<const Tree> GetTree(VertexId from) const;
+    std::shared_ptr<const Tree> BuildTree(VertexId from) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::has_infinity
+        ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+    static constexpr PrevEdge NO_EDGE = std::numeric_limits<PrevEdge>::max();
+
+    const Graph& graph_;
+    mutable cache::LruCache<VertexId, std::shared_ptr<const Tree>> trees_;
+};
+
+template <typename Weight>
+ShortestPathTreeRouter<Weight>::ShortestPathTreeRouter(const Graph& graph, size_t cache_bytes)
+    : graph_(graph)
+    , trees_(cache_bytes)
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for shortest path trees");
+    }
+    graph.CheckNonNegativeWeights();
+}
+
+// Дерево строится вне блокировки кэша, поэтому одновременные запросы из одной вершины
+// могут построить его дважды; в кэше останется одно
+template <typename Weight>
+std::shared_ptr<const typename ShortestPathTreeRouter<Weight>::Tree> ShortestPathTreeRouter<Weight>::GetTree(
+    VertexId from) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (auto tree = trees_.Get(from)) {
+        return std::move(*tree);
+    }
+    auto tree = BuildTree(from);
+    trees_.Put(from, tree, tree->GetBytes());
+    return tree;
+}
+
+template <typename Weight>
+std::shared_ptr<const typename ShortestPathTreeRouter<Weight>::Tree> ShortestPathTreeRouter<Weight>::BuildTree(
+    VertexId from) const {
+    auto tree = std::make_shared<Tree>();
+    tree->weights.assign(graph_.GetVertexCount(), INFINITE_WEIGHT);
+    tree->prev_edges.assign(graph_.GetVertexCount(), NO_EDGE);
+    std::vector<bool> settled(graph_.GetVertexCount(), false);
+    auto& weights = tree->weights;
+    auto& prev_edges = tree->prev_edges;
+    Queue queue;
+
+    weights[from] = ZERO_WEIGHT;
+    queue.push({ ZERO_WEIGHT, from });
+
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (settled[vertex]) {
+            continue;
+        }
+        settled[vertex] = true;
+        const auto relax_edge = [&, weight = weight](EdgeId edge_id, VertexId vertex_to, Weight edge_weight) {
+            const Weight candidate_weight = weight + edge_weight;
+            if (!settled[vertex_to] && candidate_weight < weights[vertex_to]) {
+                weights[vertex_to] = candidate_weight;
+                prev_edges[vertex_to] = static_cast<PrevEdge>(edge_id);
+                queue.push({ candidate_weight, vertex_to });
+            }
+        };
+        graph_.ForEachOutgoingEdge(vertex, relax_edge);
+    }
+
+    return tree;
+}
+
+template <typename Weight>
+std::optional<typename ShortestPathTreeRouter<Weight>::RouteInfo> ShortestPathTreeRouter<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    if (to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const auto tree = GetTree(from);
+    if (tree->weights[to] == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (PrevEdge edge_id = tree->prev_edges[to];
+        edge_id != NO_EDGE;
+        edge_id = tree->prev_edges[graph_.GetEdgeUnchecked(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{ tree->weights[to], std::move(edges) };
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> ShortestPathTreeRouter<Weight>::BuildWeights(VertexId from,
+    const std::vector<VertexId>& to) const {
+    for (const VertexId vertex_to : to) {
+        if (vertex_to >= graph_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+    const auto tree = GetTree(from);
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(to.size());
+    for (const VertexId vertex_to : to) {
+        const Weight weight = tree->weights[vertex_to];
+        weights.push_back(weight == INFINITE_WEIGHT ? std::nullopt : std::optional<Weight>(weight));
+    }
+    return weights;
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,632 @@
+﻿#include "tests.h"
+
+#include "connected_components.h"
+#include "geo.h"
+#include "json.h"
+#include "json_reader.h"
+#include "lru_cache.h"
+#include "router.h"
+#include "router_kernels.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+using router::TransportRouter;
+using transport_catalogue::TransportCatalogue;
+
+const double BUS_WAIT_TIME = 2.5;
+const double BUS_VELOCITY = 37;
+
+void Check(bool condition, const std::string& message) {
+    if (!condition) {
+        throw std::logic_error("Test failed: "s + message);
+    }
+}
+
+json::Node MakeStop(const std::string& name, double latitude, double longitude, json::Dict road_distances) {
+    return json::Dict{
+        { "type"s, "Stop"s },
+        { "name"s, name },
+        { "latitude"s, latitude },
+        { "longitude"s, longitude },
+        { "road_distances"s, std::move(road_distances) },
+    };
+}
+
+json::Node MakeBus(const std::string& name, const std::vector<std::string>& stops, bool is_roundtrip) {
+    return json::Dict{
+        { "type"s, "Bus"s },
+        { "name"s, name },
+        { "stops"s, json::Array(stops.begin(), stops.end()) },
+        { "is_roundtrip"s, is_roundtrip },
+    };
+}
+
+// справочник строится тем же путём, что и в main: через JSON и JsonReader
+TransportCatalogue MakeCatalogue(json::Array base_requests) {
+    const json::Document document(json::Dict{
+        { "base_requests"s, std::move(base_requests) },
+        { "render_settings"s, json::Dict{} },
+        { "stat_requests"s, json::Array{} },
+        { "routing_settings"s, json::Dict{} },
+    });
+    std::stringstream input;
+    json::Print(document, input);
+    json_reader::JsonReader reader;
+    reader.ReadInput(input);
+    return reader.CreateDatabase();
+}
+
+// Несимметричные расстояния, параллельные рёбра автобусов 1 и 4 из A в C, круговые маршруты,
+// остановка H без автобусов и отдельная сеть из I и J
+TransportCatalogue MakeSmallNetwork() {
+    return MakeCatalogue({
+        MakeStop("A"s, 55.600, 37.600, { { "B"s, 1200 }, { "E"s, 2500 } }),
+        MakeStop("B"s, 55.610, 37.620, { { "A"s, 1500 }, { "C"s, 900 }, { "E"s, 1100 } }),
+        MakeStop("C"s, 55.620, 37.610, { { "D"s, 1300 }, { "E"s, 700 } }),
+        MakeStop("D"s, 55.630, 37.630, { { "C"s, 1600 }, { "F"s, 2100 } }),
+        MakeStop("E"s, 55.615, 37.640, { { "F"s, 800 }, { "C"s, 1000 }, { "G"s, 1900 } }),
+        MakeStop("F"s, 55.625, 37.650, { { "C"s, 1400 }, { "D"s, 2000 } }),
+        MakeStop("G"s, 55.600, 37.660, { { "E"s, 1700 } }),
+        MakeStop("H"s, 55.640, 37.580, {}),
+        MakeStop("I"s, 55.700, 37.700, { { "J"s, 600 } }),
+        MakeStop("J"s, 55.710, 37.710, { { "I"s, 900 } }),
+        MakeBus("1"s, { "A"s, "B"s, "C"s, "D"s }, false),
+        MakeBus("2"s, { "C"s, "E"s, "F"s, "C"s }, true),
+        MakeBus("3"s, { "B"s, "E"s, "G"s }, false),
+        MakeBus("4"s, { "A"s, "E"s, "C"s }, false),
+        MakeBus("5"s, { "D"s, "F"s, "D"s }, true),
+        MakeBus("6"s, { "I"s, "J"s }, false),
+    });
+}
+
+// Сетка остановок: по строкам ходят некруговые автобусы, по чётным столбцам некруговые,
+// по нечётным круговые. Расстояния в обе стороны разные и задаются генератором с фиксированным зерном
+TransportCatalogue MakeGridNetwork() {
+    static const int GRID_SIZE = 8;
+    uint32_t seed = 12345;
+    const auto next_distance = [&seed] {
+        seed = seed * 1103515245 + 12345;
+        return static_cast<int>(300 + (seed >> 16) % 1700);
+    };
+    const auto stop_name = [](int row, int column) {
+        return "R"s + std::to_string(row) + "C"s + std::to_string(column);
+    };
+
+    std::map<std::string, json::Dict> road_distances;
+    const auto add_distances = [&](const std::string& from, const std::string& to) {
+        road_distances[from][to] = next_distance();
+        road_distances[to][from] = next_distance();
+    };
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int column = 0; column < GRID_SIZE; ++column) {
+            if (column + 1 < GRID_SIZE) {
+                add_distances(stop_name(row, column), stop_name(row, column + 1));
+            }
+            if (row + 1 < GRID_SIZE) {
+                add_distances(stop_name(row, column), stop_name(row + 1, column));
+            }
+        }
+    }
+
+    json::Array base_requests;
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        for (int column = 0; column < GRID_SIZE; ++column) {
+            const std::string name = stop_name(row, column);
+            base_requests.push_back(MakeStop(name, 55.5 + row * 0.01, 37.5 + column * 0.015,
+                std::move(road_distances[name])));
+        }
+    }
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        std::vector<std::string> stops;
+        for (int column = 0; column < GRID_SIZE; ++column) {
+            stops.push_back(stop_name(row, column));
+        }
+        base_requests.push_back(MakeBus("row "s + std::to_string(row), stops, false));
+    }
+    for (int column = 0; column < GRID_SIZE; ++column) {
+        std::vector<std::string> stops;
+        for (int row = 0; row < GRID_SIZE; ++row) {
+            stops.push_back(stop_name(row, column));
+        }
+        const bool is_roundtrip = column % 2 == 1;
+        if (is_roundtrip) {
+            for (int row = GRID_SIZE - 2; row >= 0; --row) {
+                stops.push_back(stop_name(row, column));
+            }
+        }
+        base_requests.push_back(MakeBus("column "s + std::to_string(column), stops, is_roundtrip));
+    }
+    return MakeCatalogue(std::move(base_requests));
+}
+
+RoutingSettings MakeSettings(RouterType router_type, GraphModel graph_model, bool use_integer_weights) {
+    RoutingSettings settings;
+    settings.bus_wait_time = BUS_WAIT_TIME;
+    settings.bus_velocity = BUS_VELOCITY;
+    settings.router_type = router_type;
+    settings.graph_model = graph_model;
+    settings.use_integer_weights = use_integer_weights;
+    return settings;
+}
+
+// с целочисленными весами движки обязаны совпасть точно, с вещественными -
+// с точностью до погрешности сложения рёбер в другом порядке
+void CheckSameTime(double expected, double actual, bool exact, const std::string& message) {
+    const bool same = exact ? expected == actual : std::abs(expected - actual) <= 1e-9 * std::max(1.0, expected);
+    Check(same, message + ": expected "s + std::to_string(expected) + ", got "s + std::to_string(actual));
+}
+
+// время маршрута складывается из времён его частей
+void CheckTimecuts(const RouteResponse& response, const std::string& message) {
+    double time = 0;
+    for (const auto& time_cut : response.time_cuts) {
+        time += std::visit([](const auto& item) {
+            return item.time;
+        }, time_cut);
+    }
+    Check(std::abs(time - response.total_time)
+        <= 1e-9 * (1 + response.time_cuts.size()) * std::max(1.0, response.total_time),
+        message + ": timecuts don't sum up to the total time"s);
+}
+
+void CheckEnginesAgainstAllPairs(const TransportCatalogue& catalogue, const std::string& network) {
+    static const std::vector<std::pair<RouterType, std::string_view>> ENGINES = {
+        { RouterType::ALL_PAIRS, "all_pairs"sv },
+        { RouterType::DIJKSTRA, "dijkstra"sv },
+        { RouterType::CONTRACTION_HIERARCHIES, "contraction_hierarchies"sv },
+        { RouterType::A_STAR, "a_star"sv },
+        { RouterType::BIDIRECTIONAL_DIJKSTRA, "bidirectional_dijkstra"sv },
+        { RouterType::SHORTEST_PATH_TREES, "shortest_path_trees"sv },
+        { RouterType::RAPTOR, "raptor"sv },
+    };
+
+    std::vector<std::string_view> stop_names;
+    for (const Stop* stop : catalogue.GetSortedStops()) {
+        stop_names.push_back(stop->name);
+    }
+
+    for (const GraphModel graph_model : { GraphModel::WAIT_EDGES, GraphModel::BOARDING_WAIT }) {
+        for (const bool use_integer_weights : { false, true }) {
+            const TransportRouter baseline(MakeSettings(RouterType::ALL_PAIRS, graph_model, use_integer_weights),
+                catalogue);
+            const auto expected = baseline.GetTravelTimes(stop_names, stop_names);
+
+            for (const auto& [router_type, engine_name] : ENGINES) {
+                // RAPTOR не строит граф и считает время без округления
+                if (router_type == RouterType::RAPTOR && use_integer_weights) {
+                    continue;
+                }
+                const std::string engine = network + ", "s + std::string(engine_name)
+                    + (graph_model == GraphModel::WAIT_EDGES ? ", wait_edges"s : ", boarding_wait"s)
+                    + (use_integer_weights ? ", integer weights"s : ""s);
+                const TransportRouter router(MakeSettings(router_type, graph_model, use_integer_weights), catalogue);
+                const auto times = router.GetTravelTimes(stop_names, stop_names);
+
+                for (size_t i = 0; i < stop_names.size(); ++i) {
+                    for (size_t j = 0; j < stop_names.size(); ++j) {
+                        const std::string message = engine + ", "s + std::string(stop_names[i]) + " -> "s
+                            + std::string(stop_names[j]);
+                        const auto route = router.GetRoute(stop_names[i], stop_names[j]);
+                        Check(route.has_value() == expected[i][j].has_value(), message + ": reachability differs"s);
+                        Check(times[i][j].has_value() == expected[i][j].has_value(),
+                            message + ": matrix reachability differs"s);
+                        if (!route) {
+                            continue;
+                        }
+                        CheckSameTime(*expected[i][j], route->total_time, use_integer_weights, message);
+                        CheckSameTime(*expected[i][j], *times[i][j], use_integer_weights, message + " (matrix)"s);
+                        CheckTimecuts(*route, message);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Время считается по известной формуле, с целочисленными весами каждая часть
+// округляется вверх до десятой доли секунды, а недостижимые остановки маршрута не дают
+void TestSmallNetworkRoutes() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    for (const bool use_integer_weights : { false, true }) {
+        const TransportRouter router(MakeSettings(RouterType::ALL_PAIRS, GraphModel::WAIT_EDGES, use_integer_weights),
+            catalogue);
+        const auto route = router.GetRoute("A"sv, "B"sv);
+        Check(route.has_value(), "A -> B is reachable"s);
+        // 1200 метров при 37 км/ч - 1167.57 десятых долей секунды, округляются до 1168
+        const double expected = use_integer_weights
+            ? (BUS_WAIT_TIME * 600 + 1168) / 600
+            : BUS_WAIT_TIME + 1200.0 / 1000 / BUS_VELOCITY * 60;
+        CheckSameTime(expected, route->total_time, use_integer_weights, "A -> B"s);
+        Check(route->time_cuts.size() == 2, "A -> B is one wait and one ride"s);
+
+        Check(!router.GetRoute("A"sv, "I"sv), "A -> I is unreachable"s);
+        Check(!router.GetRoute("H"sv, "A"sv), "H has no buses"s);
+        Check(router.GetRoute("G"sv, "A"sv).has_value(), "G -> A goes back through E and B"s);
+    }
+}
+
+// Статистика автобусов готовится в Freeze: некруговой маршрут проходится туда и обратно,
+// а незаданное расстояние C -> B берётся из B -> C
+void TestBusStats() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    const auto geo_length = [&catalogue](const std::vector<std::string_view>& stops) {
+        double length = 0;
+        for (size_t i = 1; i < stops.size(); ++i) {
+            length += geo::ComputeDistance(catalogue.FindStopByName(stops[i - 1])->coordinates,
+                catalogue.FindStopByName(stops[i])->coordinates);
+        }
+        return length;
+    };
+
+    const BusResponse bus1 = catalogue.GetBusInfo("1"sv);
+    Check(bus1.bus_exist, "bus 1 exists"s);
+    Check(bus1.stops_count == 7, "bus 1 goes there and back through 7 stops"s);
+    Check(bus1.unique_stops_count == 4, "bus 1 has 4 unique stops"s);
+    Check(bus1.route_length == 1200 + 900 + 1300 + 1600 + 900 + 1500, "bus 1 route length"s);
+    CheckSameTime(bus1.route_length / geo_length({ "A"sv, "B"sv, "C"sv, "D"sv, "C"sv, "B"sv, "A"sv }),
+        bus1.curvature, false, "bus 1 curvature"s);
+
+    const BusResponse bus2 = catalogue.GetBusInfo("2"sv);
+    Check(bus2.stops_count == 4 && bus2.unique_stops_count == 3, "round bus 2 stops"s);
+    Check(bus2.route_length == 700 + 800 + 1400, "round bus 2 route length"s);
+    CheckSameTime(bus2.route_length / geo_length({ "C"sv, "E"sv, "F"sv, "C"sv }), bus2.curvature, false,
+        "round bus 2 curvature"s);
+
+    Check(!catalogue.GetBusInfo("7"sv).bus_exist, "bus 7 doesn't exist"s);
+}
+
+// Расстояние берётся в заданном направлении, а если его нет - в обратном
+void TestDistances() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    const auto distance = [&catalogue](std::string_view from, std::string_view to) {
+        const Distance by_pointers = catalogue.GetDistance(catalogue.FindStopByName(from),
+            catalogue.FindStopByName(to));
+        const Distance by_ids = catalogue.GetDistance(catalogue.FindStopId(from), catalogue.FindStopId(to));
+        Check(by_pointers == by_ids, "distance by pointers and by ids"s);
+        return by_ids;
+    };
+
+    Check(distance("A"sv, "B"sv) == 1200 && distance("B"sv, "A"sv) == 1500, "both directions are set"s);
+    Check(distance("C"sv, "E"sv) == 700 && distance("E"sv, "C"sv) == 1000, "both directions are set"s);
+    Check(distance("C"sv, "B"sv) == 900, "C -> B falls back to B -> C"s);
+    Check(distance("F"sv, "E"sv) == 800, "F -> E falls back to E -> F"s);
+    Check(distance("J"sv, "I"sv) == 900, "J -> I is set"s);
+
+    bool has_thrown = false;
+    try {
+        distance("A"sv, "D"sv);
+    }
+    catch (const std::out_of_range&) {
+        has_thrown = true;
+    }
+    Check(has_thrown, "A -> D isn't set in either direction"s);
+}
+
+// Автобусы остановки упорядочены по названию и идут без повторов
+void TestStopBuses() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    const auto stop_buses = [&catalogue](std::string_view stop) {
+        const StopResponse response = catalogue.GetStopInfo(stop);
+        Check(response.stop_exist, "stop "s + std::string(stop) + " exists"s);
+        return std::vector<std::string_view>(response.buses.begin(), response.buses.end());
+    };
+
+    Check(stop_buses("C"sv) == std::vector{ "1"sv, "2"sv, "4"sv }, "buses of C"s);
+    Check(stop_buses("E"sv) == std::vector{ "2"sv, "3"sv, "4"sv }, "buses of E"s);
+    Check(stop_buses("D"sv) == std::vector{ "1"sv, "5"sv }, "buses of D"s);
+    Check(stop_buses("H"sv).empty(), "H has no buses"s);
+    Check(!catalogue.GetStopInfo("K"sv).stop_exist, "stop K doesn't exist"s);
+}
+
+// Два автобуса по одним и тем же остановкам дают параллельные рёбра в обе стороны
+void TestPrunedEdges() {
+    const TransportCatalogue catalogue = MakeCatalogue({
+        MakeStop("A"s, 55.600, 37.600, { { "B"s, 1200 } }),
+        MakeStop("B"s, 55.610, 37.620, {}),
+        MakeBus("1"s, { "A"s, "B"s }, false),
+        MakeBus("2"s, { "A"s, "B"s }, false),
+    });
+    for (const GraphModel graph_model : { GraphModel::WAIT_EDGES, GraphModel::BOARDING_WAIT }) {
+        RoutingSettings settings = MakeSettings(RouterType::DIJKSTRA, graph_model, false);
+        const TransportRouter pruned(settings, catalogue);
+        Check(pruned.GetPrunedEdgeCount() == 2, "one of the two edges in each direction is pruned"s);
+        settings.prune_parallel_edges = false;
+        const TransportRouter unpruned(settings, catalogue);
+        Check(unpruned.GetPrunedEdgeCount() == 0, "nothing is pruned when pruning is off"s);
+
+        for (const auto& [from, to] : { std::pair{ "A"sv, "B"sv }, std::pair{ "B"sv, "A"sv } }) {
+            const auto pruned_route = pruned.GetRoute(from, to);
+            const auto unpruned_route = unpruned.GetRoute(from, to);
+            Check(pruned_route && unpruned_route, "A and B are connected"s);
+            Check(pruned_route->total_time == unpruned_route->total_time, "pruning keeps the lightest edge"s);
+        }
+    }
+}
+
+// 0 <-> 1 -> 2, 3 <-> 4 и отдельная вершина 5: сильные компоненты {0, 1}, {2}, {3, 4}, {5},
+// слабые {0, 1, 2}, {3, 4}, {5}
+void TestConnectedComponents() {
+    graph::DirectedWeightedGraph<double> graph(6);
+    for (const auto& [from, to] : { std::pair{ 0, 1 }, std::pair{ 1, 0 }, std::pair{ 1, 2 }, std::pair{ 3, 4 },
+        std::pair{ 4, 3 } }) {
+        graph.AddEdge({ static_cast<graph::VertexId>(from), static_cast<graph::VertexId>(to), 1.0 });
+    }
+    graph.Freeze();
+    const graph::ConnectedComponents components(graph);
+    Check(components.GetStrongComponentCount() == 4, "4 strong components"s);
+    Check(components.GetWeakComponentCount() == 3, "3 weak components"s);
+    Check(components.MayReach(0, 2) && components.MayReach(1, 0) && components.MayReach(3, 4),
+        "reachable vertices aren't rejected"s);
+    Check(!components.MayReach(2, 0), "2 -> 0 goes against the edges"s);
+    Check(!components.MayReach(0, 3) && !components.MayReach(5, 4), "separate parts of the graph"s);
+}
+
+void TestLruCache() {
+    cache::LruCache<int, int> lru(2);
+    lru.Put(1, 10);
+    lru.Put(2, 20);
+    Check(lru.Get(1) == 10, "1 is cached"s);
+    lru.Put(3, 30); // вытесняет 2, к которому дольше всего не обращались
+    Check(!lru.Get(2), "2 is evicted"s);
+    Check(lru.Get(1) == 10 && lru.Get(3) == 30, "1 and 3 stay cached"s);
+    lru.Put(4, 40, 3); // дороже всей ёмкости, не кэшируется и ничего не вытесняет
+    Check(!lru.Get(4) && lru.Get(1) == 10, "too expensive value isn't cached"s);
+    lru.Put(5, 50, 2); // вытесняет оба значения
+    Check(!lru.Get(1) && !lru.Get(3) && lru.Get(5) == 50, "expensive value evicts both values"s);
+
+    const cache::CacheStats stats = lru.GetStats();
+    Check(stats.hits == 5 && stats.misses == 4 && stats.evictions == 3, "LRU cache stats"s);
+}
+
+void TestRouteCache() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    RoutingSettings settings = MakeSettings(RouterType::DIJKSTRA, GraphModel::WAIT_EDGES, false);
+    const TransportRouter uncached(settings, catalogue);
+    settings.route_cache_size = 1;
+    const TransportRouter cached(settings, catalogue);
+
+    const auto check_route = [&](std::string_view from, std::string_view to) {
+        const auto expected = uncached.GetRoute(from, to);
+        const auto route = cached.GetRoute(from, to);
+        Check(expected.has_value() == route.has_value()
+            && (!route || (route->total_time == expected->total_time
+                && route->time_cuts.size() == expected->time_cuts.size())),
+            "cached route "s + std::string(from) + " -> "s + std::string(to));
+    };
+    check_route("A"sv, "D"sv);
+    check_route("A"sv, "D"sv);
+    check_route("A"sv, "I"sv); // недостижимость тоже кэшируется, A -> D вытесняется
+    check_route("A"sv, "I"sv);
+    check_route("A"sv, "D"sv);
+
+    cache::CacheStats stats = cached.GetRouteCacheStats();
+    Check(stats.hits == 2 && stats.misses == 3 && stats.evictions == 2, "route cache stats"s);
+    Check(uncached.GetRouteCacheStats().misses == 0, "disabled cache isn't used"s);
+
+    cached.ClearRouteCache();
+    check_route("A"sv, "D"sv);
+    stats = cached.GetRouteCacheStats();
+    Check(stats.misses == 4 && stats.evictions == 2, "cleared cache misses without evictions"s);
+}
+
+// Ленивый маршрутизатор строится первым запросом, остальные готовы к концу конструктора или ожидания
+void TestWarmUp() {
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    for (const RouterType router_type : { RouterType::ALL_PAIRS, RouterType::DIJKSTRA }) {
+        RoutingSettings settings = MakeSettings(router_type, GraphModel::WAIT_EDGES, false);
+
+        settings.warm_up = WarmUpMode::LAZY;
+        const TransportRouter lazy(settings, catalogue);
+        Check(!lazy.IsReady(), "lazy router isn't built by the constructor"s);
+        Check(lazy.GetRoute("A"sv, "D"sv).has_value(), "lazy router builds a route"s);
+        Check(lazy.IsReady(), "lazy router is built by the first request"s);
+
+        settings.warm_up = WarmUpMode::EAGER;
+        const TransportRouter eager(settings, catalogue);
+        Check(eager.IsReady(), "eager router is built by the constructor"s);
+
+        settings.warm_up = WarmUpMode::BACKGROUND;
+        const TransportRouter background(settings, catalogue);
+        Check(background.WaitUntilReady(std::chrono::minutes(1)), "background router is built"s);
+        Check(background.IsReady(), "background router is ready after waiting"s);
+        Check(background.GetRoute("A"sv, "D"sv)->total_time == lazy.GetRoute("A"sv, "D"sv)->total_time,
+            "background and lazy routers agree"s);
+    }
+
+    const TransportRouter raptor(MakeSettings(RouterType::RAPTOR, GraphModel::WAIT_EDGES, false), catalogue);
+    Check(raptor.IsReady(), "RAPTOR needs no warm-up"s);
+}
+
+void CheckSameRoutes(const TransportRouter& expected, const TransportRouter& actual,
+    const TransportCatalogue& catalogue, const std::string& message) {
+    std::vector<std::string_view> stop_names;
+    for (const Stop* stop : catalogue.GetSortedStops()) {
+        stop_names.push_back(stop->name);
+    }
+    Check(expected.GetTravelTimes(stop_names, stop_names) == actual.GetTravelTimes(stop_names, stop_names),
+        message + ": travel times differ"s);
+    for (const std::string_view from : stop_names) {
+        for (const std::string_view to : stop_names) {
+            const auto expected_route = expected.GetRoute(from, to);
+            const auto route = actual.GetRoute(from, to);
+            Check(expected_route.has_value() == route.has_value()
+                && (!route || route->time_cuts.size() == expected_route->time_cuts.size()),
+                message + ": route "s + std::string(from) + " -> "s + std::string(to) + " differs"s);
+        }
+    }
+}
+
+// Снимок сохраняется после сборки таблицы и загружается следующим маршрутизатором;
+// снимок другого справочника и испорченный файл не загружаются, таблица строится заново
+void TestSnapshot() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "transport_router_test_snapshot.bin";
+    std::filesystem::remove(path);
+
+    const TransportCatalogue catalogue = MakeSmallNetwork();
+    RoutingSettings settings = MakeSettings(RouterType::ALL_PAIRS, GraphModel::WAIT_EDGES, false);
+    settings.snapshot_file = path.string();
+    {
+        const TransportRouter built(settings, catalogue);
+        Check(!built.IsReady() && built.GetPrunedEdgeCount() > 0, "the first router builds the graph"s);
+        built.WaitUntilReady();
+        Check(std::filesystem::exists(path), "snapshot is saved after the routes table is built"s);
+
+        const TransportRouter loaded(settings, catalogue);
+        Check(loaded.IsReady() && loaded.GetPrunedEdgeCount() == 0, "the second router loads the snapshot"s);
+        CheckSameRoutes(built, loaded, catalogue, "loaded snapshot"s);
+    }
+
+    const TransportCatalogue grid = MakeGridNetwork();
+    const TransportRouter rebuilt(settings, grid);
+    Check(!rebuilt.IsReady(), "snapshot of another catalogue isn't loaded"s);
+    RoutingSettings no_snapshot_settings = settings;
+    no_snapshot_settings.snapshot_file.clear();
+    CheckSameRoutes(TransportRouter(no_snapshot_settings, grid), rebuilt, grid, "rejected snapshot"s);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a snapshot"s;
+    const TransportRouter after_corruption(settings, grid);
+    Check(!after_corruption.IsReady(), "corrupted snapshot isn't loaded"s);
+    CheckSameRoutes(rebuilt, after_corruption, grid, "corrupted snapshot"s);
+
+    std::filesystem::remove(path);
+}
+
+// Случайный граф, в котором много маршрутов одинакового веса и веса не представимы точно в double
+template <typename Weight, typename MakeWeight>
+graph::DirectedWeightedGraph<Weight> MakeRandomGraph(size_t vertex_count, const MakeWeight& make_weight) {
+    uint32_t seed = 54321;
+    const auto next = [&seed](uint32_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % bound;
+    };
+    graph::DirectedWeightedGraph<Weight> graph(vertex_count);
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        for (int i = 0; i < 4; ++i) {
+            graph.AddEdge({ from, next(static_cast<uint32_t>(vertex_count)), make_weight(next(50)) });
+        }
+    }
+    graph.Freeze();
+    return graph;
+}
+
+template <typename Weight>
+bool HasSameBits(const graph::FlatBuffer<Weight>& lhs, const graph::FlatBuffer<Weight>& rhs) {
+    return lhs.Size() == rhs.Size() && std::memcmp(lhs.Data(), rhs.Data(), lhs.Size() * sizeof(Weight)) == 0;
+}
+
+// Таблица Флойда-Уоршелла не зависит от числа потоков побитово
+template <typename Weight>
+void CheckRoutesTableThreads(const graph::DirectedWeightedGraph<Weight>& graph, const std::string& message) {
+    const graph::Router<Weight> sequential(graph, { false, 1 });
+    for (const size_t thread_count : { 2, 3, 0 }) {
+        const graph::Router<Weight> parallel(graph, { false, thread_count });
+        Check(HasSameBits(sequential.GetWeights(), parallel.GetWeights())
+            && HasSameBits(sequential.GetPrevEdges(), parallel.GetPrevEdges()),
+            message + ": routes table differs with "s + std::to_string(thread_count) + " threads"s);
+    }
+}
+
+void TestRoutesTableThreads() {
+    // больше полосы столбцов, чтобы строки обрабатывались по частям
+    static const size_t VERTEX_COUNT = 600;
+    CheckRoutesTableThreads(MakeRandomGraph<double>(VERTEX_COUNT, [](uint32_t value) {
+        return value / 7.0;
+    }), "double weights"s);
+    CheckRoutesTableThreads(MakeRandomGraph<graph::DeciSeconds>(VERTEX_COUNT, [](uint32_t value) {
+        return graph::DeciSeconds{ value * 100 };
+    }), "deci-seconds weights"s);
+}
+
+// Векторное ядро, выбранное по процессору, совпадает со скалярным побитово: на недостижимых
+// вершинах, равных весах, переполнении и хвосте, который не заполняет вектор целиком
+template <typename Weight, typename MakeWeight>
+void CheckRelaxRowKernel(Weight infinite_weight, const MakeWeight& make_weight, const std::string& message) {
+    static const size_t COUNT = 1003;
+    uint32_t seed = 777;
+    const auto next = [&seed](uint32_t bound) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % bound;
+    };
+    std::vector<Weight> weights_relaxing(COUNT);
+    std::vector<Weight> weights_through(COUNT);
+    std::vector<uint32_t> prev_edges_relaxing(COUNT);
+    std::vector<uint32_t> prev_edges_through(COUNT);
+    for (size_t i = 0; i < COUNT; ++i) {
+        weights_relaxing[i] = next(8) == 0 ? infinite_weight : make_weight(next(100));
+        weights_through[i] = next(8) == 0 ? infinite_weight : make_weight(next(100));
+        prev_edges_relaxing[i] = next(1000);
+        prev_edges_through[i] = next(4) == 0 ? graph::NO_PREV_EDGE : next(1000);
+    }
+
+    for (const uint32_t from_value : { 0u, 3u, 50u, 99u }) {
+        for (const size_t offset : { 0, 1, 5 }) {
+            auto scalar_weights = weights_relaxing;
+            auto scalar_prev_edges = prev_edges_relaxing;
+            auto weights = weights_relaxing;
+            auto prev_edges = prev_edges_relaxing;
+            const size_t count = COUNT - offset;
+            graph::RelaxRowScalar(scalar_weights.data() + offset, scalar_prev_edges.data() + offset,
+                make_weight(from_value), 7, weights_through.data() + offset, prev_edges_through.data() + offset,
+                count);
+            graph::RelaxRow(weights.data() + offset, prev_edges.data() + offset, make_weight(from_value), 7,
+                weights_through.data() + offset, prev_edges_through.data() + offset, count);
+            Check(std::memcmp(weights.data(), scalar_weights.data(), COUNT * sizeof(Weight)) == 0
+                && prev_edges == scalar_prev_edges,
+                message + ": kernels differ with offset "s + std::to_string(offset));
+        }
+    }
+}
+
+void TestRelaxRowKernels() {
+    CheckRelaxRowKernel<double>(std::numeric_limits<double>::infinity(), [](uint32_t value) {
+        return value / 7.0;
+    }, "double weights"s);
+    // большие веса, чтобы сумма переполнялась
+    CheckRelaxRowKernel<uint32_t>(UINT32_MAX, [](uint32_t value) {
+        return value < 90 ? value : UINT32_MAX - value;
+    }, "uint32 weights"s);
+}
+
+} // namespace
+
+void RunTests() {
+    TestBusStats();
+    TestDistances();
+    TestStopBuses();
+    TestSmallNetworkRoutes();
+    TestPrunedEdges();
+    TestConnectedComponents();
+    TestLruCache();
+    TestRouteCache();
+    TestWarmUp();
+    TestSnapshot();
+    TestRoutesTableThreads();
+    TestRelaxRowKernels();
+    CheckEnginesAgainstAllPairs(MakeSmallNetwork(), "small network"s);
+    CheckEnginesAgainstAllPairs(MakeSmallNetwork(), "small network"s);
+    CheckEnginesAgainstAllPairs(MakeGridNetwork(), "grid network"s);
+    std::cerr << "All tests passed"sv << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+﻿#pragma once
+
+// Проверяет справочник (статистику автобусов, расстояния, автобусы остановок), компоненты связности,
+// кэши, прогрев, снимок таблицы маршрутов и её побитовую независимость от числа потоков и векторного ядра.
+// Ответы всех движков маршрутов сверяются с таблицей всех маршрутов (Флойд-Уоршелл):
+// на маленькой сети с недостижимыми остановками и на сгенерированной сетке, в обеих моделях
+// графа, с вещественными и целочисленными весами. При расхождении кидает logic_error
+void RunTests();
\ No newline at end of file
@@ -1,19 +1,36 @@
 ﻿#include "transport_catalogue.h"
 
+#include "hashing.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <tuple>
+
 namespace transport_catalogue {
 
 void TransportCatalogue::AddBus(Bus&& bus) {
+    CheckNotFrozen();
+    bus.id = static_cast<BusId>(buses_.size());
     buses_.push_back(std::move(bus));
     buses_table_.insert({ buses_.back().name, &buses_.back() });
+    const std::string_view name = buses_.back().name;
     for (const auto& stop : buses_.back().stops) {
-        stops_to_buses_.at(stop->name).insert(buses_.back().name);
+        auto& stop_buses = stop_buses_[stop->id];
+        const auto it = std::lower_bound(stop_buses.begin(), stop_buses.end(), name);
+        if (it == stop_buses.end() || *it != name) {
+            stop_buses.insert(it, name);
+        }
     }
 }
 
 void TransportCatalogue::AddStop(Stop&& stop) {
+    CheckNotFrozen();
+    stop.id = static_cast<StopId>(stops_.size());
     stops_.push_back(std::move(stop));
     stops_table_.insert({ stops_.back().name, &stops_.back() });
-    stops_to_buses_[stops_.back().name];
+    stop_names_.push_back(stops_.back().name);
+    stop_coordinates_.push_back(stops_.back().coordinates);
+    stop_buses_.emplace_back();
 }
 
 Bus* TransportCatalogue::FindBusByName(std::string_view name) const {
@@ -30,93 +47,239 @@ Stop* TransportCatalogue::FindStopByName(std::string_view name) const {
     return stops_table_.at(name);
 }
 
-BusResponse TransportCatalogue::GetBusInfo(std::string_view busname) const {
-    BusResponse response;
-    try {
-        const auto& stops = FindBusByName(busname)->stops; // может кинуть исключение
-        response.bus_exist = true;
-        response.stops_count = stops.size();
-        std::unordered_set<Stop*> unique_stops;
-        for (const auto& stop : stops) {
-            unique_stops.insert(stop);
-        }
-        response.unique_stops_count = unique_stops.size();
-        auto straight_route_length = ComputeRouteLength(busname);
-        response.route_length = ComputeRoadBasedRouteLength(busname);
-        response.curvature = response.route_length / straight_route_length;
+StopId TransportCatalogue::FindStopId(std::string_view name) const {
+    return FindStopByName(name)->id;
+}
 
-        return response;
-    }
-    catch (std::invalid_argument&) {
+size_t TransportCatalogue::GetStopCount() const {
+    return stops_.size();
+}
+
+size_t TransportCatalogue::GetBusCount() const {
+    return buses_.size();
+}
+
+const Bus& TransportCatalogue::GetBus(BusId id) const {
+    return buses_[id];
+}
+
+std::string_view TransportCatalogue::GetStopName(StopId id) const {
+    return stop_names_[id];
+}
+
+const geo::Coordinates& TransportCatalogue::GetStopCoordinates(StopId id) const {
+    return stop_coordinates_[id];
+}
+
+BusResponse TransportCatalogue::GetBusInfo(std::string_view busname) const {
+    const auto it = buses_table_.find(busname);
+    if (it == buses_table_.end()) {
+        BusResponse response;
         response.bus_exist = false;
         return response;
     }
+    if (frozen_) {
+        return bus_stats_[it->second->id];
+    }
+    return ComputeBusStats(*it->second);
 }
 
 StopResponse TransportCatalogue::GetStopInfo(std::string_view stopname) const {
     StopResponse response;
 
-    if (!stops_to_buses_.count(stopname)) {
+    const auto it = stops_table_.find(stopname);
+    if (it == stops_table_.end()) {
         response.stop_exist = false;
         return response;
     }
-    if (stops_to_buses_.count(stopname) && stops_to_buses_.at(stopname).empty()) {
-        response.stop_exist = true;
-        return response;
+    response.stop_exist = true;
+    const StopId id = it->second->id;
+    if (frozen_) {
+        response.buses = Buses{ stop_buses_names_.begin() + stop_buses_offsets_[id],
+            stop_buses_names_.begin() + stop_buses_offsets_[id + 1] };
     }
-    if (stops_to_buses_.count(stopname) && !stops_to_buses_.at(stopname).empty()) {
-        response.stop_exist = true;
-        for (const auto& bus : stops_to_buses_.at(stopname)) {
-            response.buses.push_back(bus);
-        }
-        return response;
+    else {
+        response.buses = ranges::AsRange(stop_buses_[id]);
     }
 
     return response;
 }
 
-BusesTable TransportCatalogue::GetAllBuses() const {
-    return buses_table_;
+SortedBuses TransportCatalogue::GetSortedBuses() const {
+    CheckFrozen();
+    return ranges::AsRange(sorted_buses_);
 }
 
-StopsTable TransportCatalogue::GetAllStops() const {
-    return stops_table_;
+SortedStops TransportCatalogue::GetSortedStops() const {
+    CheckFrozen();
+    return ranges::AsRange(sorted_stops_);
 }
 
 void TransportCatalogue::AddDistance(Stop* stop1, Stop* stop2, Distance distance) {
-    distances_.insert({ { stop1, stop2 }, distance });
+    CheckNotFrozen();
+    distances_.insert({ MakeIdPairKey(stop1->id, stop2->id), distance });
+}
+
+void TransportCatalogue::Freeze(size_t thread_count) {
+    if (frozen_) {
+        return;
+    }
+    // статистика автобусов уже читает расстояния из замороженных массивов
+    FreezeDistances();
+    FreezeStopBuses();
+    frozen_ = true;
+
+    for (const Bus& bus : buses_) {
+        sorted_buses_.push_back(&bus);
+    }
+    std::sort(sorted_buses_.begin(), sorted_buses_.end(), [](const Bus* lhs, const Bus* rhs) {
+        return lhs->name < rhs->name;
+    });
+    for (const Stop& stop : stops_) {
+        sorted_stops_.push_back(&stop);
+    }
+    std::sort(sorted_stops_.begin(), sorted_stops_.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+
+    bus_stats_.resize(buses_.size());
+    parallel::ForEachChunk(buses_.size(), parallel::GetThreadCount(thread_count),
+        [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                bus_stats_[i] = ComputeBusStats(buses_[i]);
+            }
+        });
+}
+
+bool TransportCatalogue::IsFrozen() const {
+    return frozen_;
+}
+
+void TransportCatalogue::CheckNotFrozen() const {
+    if (frozen_) {
+        throw std::logic_error("Catalogue is frozen");
+    }
+}
+
+void TransportCatalogue::CheckFrozen() const {
+    if (!frozen_) {
+        throw std::logic_error("Catalogue is not frozen");
+    }
+}
+
+void TransportCatalogue::FreezeStopBuses() {
+    stop_buses_offsets_.assign(stops_.size() + 1, 0);
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        stop_buses_offsets_[stop + 1] = stop_buses_offsets_[stop] + stop_buses_[stop].size();
+    }
+    stop_buses_names_.clear();
+    stop_buses_names_.reserve(stop_buses_offsets_.back());
+    for (const auto& stop_buses : stop_buses_) {
+        stop_buses_names_.insert(stop_buses_names_.end(), stop_buses.begin(), stop_buses.end());
+    }
+    std::vector<std::vector<std::string_view>>().swap(stop_buses_);
+}
+
+void TransportCatalogue::FreezeDistances() {
+    struct Entry {
+        StopId from;
+        StopId to;
+        Distance distance;
+        bool is_reverse;
+    };
+    // заданное направление важнее обратного, поэтому после сортировки оно идёт первым
+    std::vector<Entry> entries;
+    entries.reserve(distances_.size() * 2);
+    for (const auto& [key, distance] : distances_) {
+        const StopId from = static_cast<StopId>(key >> 32);
+        const StopId to = static_cast<StopId>(key);
+        entries.push_back({ from, to, distance, false });
+        entries.push_back({ to, from, distance, true });
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return std::tie(lhs.from, lhs.to, lhs.is_reverse) < std::tie(rhs.from, rhs.to, rhs.is_reverse);
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.from == rhs.from && lhs.to == rhs.to;
+    }), entries.end());
+
+    neighbours_offsets_.assign(stops_.size() + 1, 0);
+    neighbours_.clear();
+    neighbours_.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        ++neighbours_offsets_[entry.from + 1];
+        neighbours_.push_back({ entry.to, entry.distance });
+    }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        neighbours_offsets_[stop + 1] += neighbours_offsets_[stop];
+    }
+    // таблица больше не нужна, память возвращается
+    std::unordered_map<IdPairKey, Distance, IdPairHasher>().swap(distances_);
 }
 
 Distance TransportCatalogue::GetDistance(Stop* stop1, Stop* stop2) const {
-    if (!distances_.count({ stop1, stop2 })) {
-        return distances_.at({ stop2, stop1 });
+    return GetDistance(stop1->id, stop2->id);
+}
+
+Distance TransportCatalogue::GetDistance(StopId stop1, StopId stop2) const {
+    if (!frozen_) {
+        if (const auto it = distances_.find(MakeIdPairKey(stop1, stop2)); it != distances_.end()) {
+            return it->second;
+        }
+        return distances_.at(MakeIdPairKey(stop2, stop1));
     }
-    return distances_.at({ stop1, stop2 });
+    const auto begin = neighbours_.begin() + neighbours_offsets_[stop1];
+    const auto end = neighbours_.begin() + neighbours_offsets_[stop1 + 1];
+    const auto it = std::lower_bound(begin, end, stop2, [](const NeighbourDistance& neighbour, StopId stop) {
+        return neighbour.stop < stop;
+    });
+    if (it == end || it->stop != stop2) {
+        throw std::out_of_range("No distance between stops");
+    }
+    return it->distance;
 }
 
-double TransportCatalogue::ComputeRouteLength(std::string_view busname) const {
+BusResponse TransportCatalogue::ComputeBusStats(const Bus& bus) const {
+    BusResponse response;
+    response.bus_exist = true;
+    response.stops_count = bus.stops.size();
+    std::vector<StopId> unique_stops;
+    unique_stops.reserve(bus.stops.size());
+    for (const Stop* stop : bus.stops) {
+        unique_stops.push_back(stop->id);
+    }
+    std::sort(unique_stops.begin(), unique_stops.end());
+    response.unique_stops_count = std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
+    const double straight_route_length = ComputeRouteLength(bus);
+    response.route_length = ComputeRoadBasedRouteLength(bus);
+    response.curvature = response.route_length / straight_route_length;
+    return response;
+}
+
+double TransportCatalogue::ComputeRouteLength(const Bus& bus) const {
     double overall_length = 0;
-    for (size_t i = 1; i < FindBusByName(busname)->stops.size(); ++i) {
-        overall_length += geo::ComputeDistance(FindBusByName(busname)->stops[i]->coordinates, FindBusByName(busname)->stops[i - 1]->coordinates);
+    const auto& stops = bus.stops;
+    for (size_t i = 1; i < stops.size(); ++i) {
+        overall_length += geo::ComputeDistance(stops[i]->coordinates, stops[i - 1]->coordinates);
     }
     return overall_length;
 }
 
-Distance TransportCatalogue::ComputeRoadBasedRouteLength(std::string_view busname) const {
+Distance TransportCatalogue::ComputeRoadBasedRouteLength(const Bus& bus) const {
     Distance overall_length = 0;
-    const auto& stops = FindBusByName(busname)->stops;
+    const auto& stops = bus.stops;
     for (size_t i = 1; i < stops.size(); ++i) {
         overall_length += GetDistance(stops[i - 1], stops[i]);
     }
     return overall_length;
 }
 
-bool operator==(const DistancesKey& lhs, const DistancesKey& rhs) {
-    return lhs.first == rhs.first && lhs.second == rhs.second;
+IdPairKey MakeIdPairKey(uint32_t first, uint32_t second) {
+    return static_cast<IdPairKey>(first) << 32 | second;
 }
 
-std::size_t DistancesHasher::operator()(const DistancesKey& key) const {
-    return std::hash<const void*>()(key.first) + 37 * std::hash<const void*>()(key.second);
+std::size_t IdPairHasher::operator()(IdPairKey key) const {
+    return static_cast<std::size_t>(hashing::MixBits(key));
 }
 
 } // namespace transport_catalogue
\ No newline at end of file
@@ -3,21 +3,24 @@
 
 #include "domain.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <deque>
-#include <set>
 #include <string>
 #include <stdexcept>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace transport_catalogue {
 
-using DistancesKey = std::pair<Stop*, Stop*>;
+// пара 32-битных номеров остановок в расстояниях (первый << 32 | второй)
+using IdPairKey = uint64_t;
 
-struct DistancesHasher {
-    std::size_t operator()(const DistancesKey& key) const;
+IdPairKey MakeIdPairKey(uint32_t first, uint32_t second);
+
+struct IdPairHasher {
+    std::size_t operator()(IdPairKey key) const;
 };
 
 class TransportCatalogue {
@@ -26,23 +29,68 @@ public:
     void AddStop(Stop&& stop);
     Bus* FindBusByName(std::string_view name) const;
     Stop* FindStopByName(std::string_view name) const;
+    // название переводится в номер один раз, дальше данные берутся из массивов по номеру
+    StopId FindStopId(std::string_view name) const;
+    size_t GetStopCount() const;
+    size_t GetBusCount() const;
+    const Bus& GetBus(BusId id) const;
+    std::string_view GetStopName(StopId id) const;
+    const geo::Coordinates& GetStopCoordinates(StopId id) const;
     BusResponse GetBusInfo(std::string_view busname) const;
+    // список автобусов в ответе ссылается на справочник; до Freeze его портит следующий AddBus
     StopResponse GetStopInfo(std::string_view stopname) const;
-    BusesTable GetAllBuses() const;
-    StopsTable GetAllStops() const;
+    // упорядоченные по названию, готовятся в Freeze; до Freeze кидают logic_error
+    SortedBuses GetSortedBuses() const;
+    SortedStops GetSortedStops() const;
     void AddDistance(Stop* stop1, Stop* stop2, Distance distance);
+    // расстояние от stop1 до stop2, если оно не задано - от stop2 до stop1
     Distance GetDistance(Stop* stop1, Stop* stop2) const;
+    Distance GetDistance(StopId stop1, StopId stop2) const;
+    // Завершает загрузку: статистика автобусов считается один раз, параллельно по автобусам,
+    // после чего GetBusInfo только копирует готовый ответ, а расстояния переезжают в плоские
+    // массивы с уже подставленными обратными направлениями. Изменения после этого запрещены
+    void Freeze(size_t thread_count = 0);
+    bool IsFrozen() const;
 
 private:
-    double ComputeRouteLength(std::string_view busname) const;
-    Distance ComputeRoadBasedRouteLength(std::string_view busname) const;
+    void CheckNotFrozen() const;
+    void CheckFrozen() const;
+    void FreezeDistances();
+    void FreezeStopBuses();
+    BusResponse ComputeBusStats(const Bus& bus) const;
+    double ComputeRouteLength(const Bus& bus) const;
+    Distance ComputeRoadBasedRouteLength(const Bus& bus) const;
 
+    // deque не перемещает элементы, поэтому указатели и названия остаются действительными,
+    // а номер элемента совпадает с его id
     std::deque<Stop> stops_;
     std::deque<Bus> buses_;
     std::unordered_map<std::string_view, Stop*> stops_table_;
     std::unordered_map<std::string_view, Bus*> buses_table_;
-    std::unordered_map<std::string_view, Buses> stops_to_buses_;
-    std::unordered_map<DistancesKey, Distance, DistancesHasher> distances_;
+
+    // Данные остановок по столбцам, индекс - StopId. Это копии полей Stop из stops_ для плотного
+    // обхода по номеру: хранилищем остаются stops_, а Bus::stops по-прежнему указывает на Stop
+    std::vector<std::string_view> stop_names_;
+    std::vector<geo::Coordinates> stop_coordinates_;
+    std::vector<std::vector<std::string_view>> stop_buses_; // до Freeze, упорядочены при вставке
+    // расстояния, заданные при загрузке, до Freeze
+    std::unordered_map<IdPairKey, Distance, IdPairHasher> distances_;
+
+    struct NeighbourDistance {
+        StopId stop;
+        Distance distance;
+    };
+    // после Freeze: соседи каждой остановки, отсортированные по номеру, в формате CSR
+    std::vector<size_t> neighbours_offsets_;
+    std::vector<NeighbourDistance> neighbours_;
+    // после Freeze: автобусы каждой остановки одним массивом в формате CSR
+    std::vector<size_t> stop_buses_offsets_;
+    std::vector<std::string_view> stop_buses_names_;
+
+    bool frozen_ = false;
+    std::vector<BusResponse> bus_stats_; // индекс - BusId, заполняется в Freeze
+    std::vector<const Bus*> sorted_buses_;
+    std::vector<const Stop*> sorted_stops_;
 };
 
 } // namespace transport_catalogue
\ No newline at end of file
@@ -1,30 +1,271 @@
 #include "transport_router.h"
 
+#include "hashing.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
 #include <vector>
 
 namespace router {
 
+namespace {
+
+//      
+double ToMinutes(double weight) {
+    return weight;
+}
+
+double ToMinutes(graph::DeciSeconds weight) {
+    return weight.ToMinutes();
+}
+
+} // namespace
+
 TransportRouter::TransportRouter(RoutingSettings settings, const transport_catalogue::TransportCatalogue& catalogue)
     : settings_(settings)
-    , catalogue_(catalogue) {
-        InitializeStops();
-        InitializeGraph();
+    , catalogue_(catalogue)
+    , route_cache_(settings_.route_cache_size) {
+        //       ,       
+        if (!catalogue_.IsFrozen()) {
+            throw std::logic_error("Transport router needs a frozen catalogue");
+        }
+        if (settings_.router_type == RouterType::RAPTOR) {
+            // RAPTOR     ,    ,
+            //       
+            InitializeStops();
+            raptor_ = std::make_unique<RaptorRouter>(settings_, catalogue_);
+            return;
+        }
+        //        ,      
+        if (!UsesSnapshot() || !LoadSnapshot()) {
+            InitializeStops();
+            InitializeGraph();
+        }
+        components_ = std::visit([](const auto& graph) {
+            return graph::ConnectedComponents(graph);
+        }, graph_);
+
+        if (IsReady()) {
+            return;
+        }
+        if (settings_.warm_up == WarmUpMode::EAGER) {
+            GetRoutingEngine();
+        }
+        else if (settings_.warm_up == WarmUpMode::BACKGROUND) {
+            warm_up_ = std::async(std::launch::async, [this] {
+                GetRoutingEngine();
+            }).share();
+        }
 }
 
 graph::VertexId TransportRouter::FindVertexIdByStopName(std::string_view stop_name) const {
-    return stops_ids_table_.at(stop_name);
+    return stop_vertices_[catalogue_.FindStopId(stop_name)];
+}
+
+void TransportRouter::AddTimecutsByEdgeId(graph::EdgeId edge_id, std::vector<Timecut>& time_cuts) const {
+    std::visit([&](const auto& graph) {
+        const auto& edge = graph.GetEdge(edge_id);
+        const uint32_t name = edge_annotations_.names[edge_id];
+        if (edge_annotations_.kinds[edge_id] == EdgeKind::WAIT) {
+            time_cuts.push_back(Wait{ ToMinutes(edge.weight), stop_names_[name] });
+            return;
+        }
+        using Weight = decltype(edge.weight);
+        if (settings_.graph_model == GraphModel::BOARDING_WAIT) {
+            time_cuts.push_back(Wait{ ToMinutes(ComputeWaitWeight<Weight>()), stop_names_[vertex_stops_[edge.from]] });
+        }
+        //     ,    ,      
+        const Weight time = ComputeRideWeight<Weight>(edge_annotations_.distances[edge_id]);
+        time_cuts.push_back(RidingBus{ ToMinutes(time), bus_names_[name], edge_annotations_.span_counts[edge_id] });
+    }, graph_);
+}
+
+size_t TransportRouter::GetVertexCountPerStop() const {
+    return settings_.graph_model == GraphModel::WAIT_EDGES ? 2 : 1;
 }
 
-Timecut TransportRouter::FindTimecutByEdgeId(graph::EdgeId edge_id) const {
-    return time_cuts_.at(edge_id);
+graph::VertexId TransportRouter::GetDepartureVertex(graph::VertexId stop_vertex) const {
+    return stop_vertex + GetVertexCountPerStop() - 1;
+}
+
+size_t TransportRouter::GetVertexCount() const {
+    return std::visit([](const auto& graph) {
+        return graph.GetVertexCount();
+    }, graph_);
+}
+
+void TransportRouter::EdgeAnnotations::Add(EdgeKind kind, uint32_t name, uint32_t span_count, double distance) {
+    kinds.push_back(kind);
+    names.push_back(name);
+    span_counts.push_back(span_count);
+    distances.push_back(distance);
+}
+
+const graph::RoutingEngine<double>& TransportRouter::GetRoutingEngine() const {
+    if (!router_ready_.load(std::memory_order_acquire)) {
+        std::call_once(router_once_, [this] {
+            router_ = CreateRoutingEngine();
+            router_ready_.store(true, std::memory_order_release);
+            //   ,    :  ,   
+            //    ;       
+            if (UsesSnapshot()) {
+                TrySaveSnapshot(static_cast<const graph::Router<double>&>(*router_));
+            }
+        });
+    }
+    return *router_;
+}
+
+bool TransportRouter::IsReady() const {
+    return raptor_ != nullptr || router_ready_.load(std::memory_order_acquire);
+}
+
+void TransportRouter::WaitUntilReady() const {
+    if (raptor_ != nullptr) {
+        return;
+    }
+    if (warm_up_.valid()) {
+        warm_up_.get(); //    
+    }
+    GetRoutingEngine();
+}
+
+bool TransportRouter::WaitUntilReady(std::chrono::milliseconds timeout) const {
+    if (warm_up_.valid() && warm_up_.wait_for(timeout) != std::future_status::ready) {
+        return false;
+    }
+    WaitUntilReady();
+    return true;
+}
+
+std::unique_ptr<graph::RoutingEngine<double>> TransportRouter::CreateRoutingEngine() const {
+    if (const auto* graph = std::get_if<graph::DirectedWeightedGraph<graph::DeciSeconds>>(&graph_)) {
+        return std::make_unique<graph::DeciSecondsRoutingEngine>(CreateRoutingEngine(*graph));
+    }
+    return CreateRoutingEngine(std::get<graph::DirectedWeightedGraph<double>>(graph_));
+}
+
+template <typename Weight>
+std::unique_ptr<graph::RoutingEngine<Weight>> TransportRouter::CreateRoutingEngine(
+    const graph::DirectedWeightedGraph<Weight>& graph) const {
+    switch (settings_.router_type) {
+    case RouterType::ALL_PAIRS:
+        return std::make_unique<graph::Router<Weight>>(graph,
+            graph::RoutesTableSettings{ settings_.use_huge_pages, settings_.thread_count });
+    case RouterType::DIJKSTRA:
+        return std::make_unique<graph::DijkstraRouter<Weight>>(graph);
+    case RouterType::CONTRACTION_HIERARCHIES:
+        return std::make_unique<graph::ContractionHierarchy<Weight>>(graph);
+    case RouterType::BIDIRECTIONAL_DIJKSTRA:
+        return std::make_unique<graph::BidirectionalDijkstraRouter<Weight>>(graph);
+    case RouterType::SHORTEST_PATH_TREES:
+        return std::make_unique<graph::ShortestPathTreeRouter<Weight>>(graph, settings_.tree_cache_bytes);
+    case RouterType::A_STAR:
+        if constexpr (std::is_same_v<Weight, double>) {
+            return std::make_unique<graph::AStarRouter<double>>(graph, CreateDistanceHeuristic());
+        }
+        else {
+            //    ,   ,    
+            return std::make_unique<graph::AStarRouter<Weight>>(graph,
+                [heuristic = CreateDistanceHeuristic()](graph::VertexId vertex, graph::VertexId target) {
+                    return Weight{ static_cast<uint32_t>(heuristic(vertex, target) * Weight::PER_MINUTE) };
+                });
+        }
+    case RouterType::RAPTOR:
+        throw std::logic_error("RAPTOR doesn't use the routing graph");
+    }
+    throw std::invalid_argument("Unknown router type");
+}
+
+graph::Heuristic<double> TransportRouter::CreateDistanceHeuristic() const {
+    //        ,   
+    //           .
+    //           .
+    //     geo::ComputeDistance   
+    static const double DISTANCE_TOLERANCE = 1;
+    double road_to_geo_ratio = std::numeric_limits<double>::infinity();
+    for (BusId bus = 0; bus < catalogue_.GetBusCount(); ++bus) {
+        const auto& stops = catalogue_.GetBus(bus).stops;
+        for (size_t k = 1; k < stops.size(); ++k) {
+            const double geo_distance = geo::ComputeDistance(stops[k - 1]->coordinates, stops[k]->coordinates)
+                + DISTANCE_TOLERANCE;
+            road_to_geo_ratio = std::min({ road_to_geo_ratio,
+                catalogue_.GetDistance(stops[k - 1], stops[k]) / geo_distance,
+                catalogue_.GetDistance(stops[k], stops[k - 1]) / geo_distance });
+        }
+    }
+    if (road_to_geo_ratio == std::numeric_limits<double>::infinity()) {
+        road_to_geo_ratio = 0;
+    }
+
+    //    ,      
+    std::vector<geo::Coordinates> coordinates(GetVertexCount());
+    for (StopId stop = 0; stop < catalogue_.GetStopCount(); ++stop) {
+        const graph::VertexId vertex_id = stop_vertices_[stop];
+        coordinates[vertex_id] = coordinates[GetDepartureVertex(vertex_id)] = catalogue_.GetStopCoordinates(stop);
+    }
+
+    const double minutes_per_meter = road_to_geo_ratio / METERS_IN_KILOMETERS / settings_.bus_velocity
+        * MINUTES_IN_HOUR;
+    return [coordinates = std::move(coordinates), minutes_per_meter](graph::VertexId vertex, graph::VertexId target) {
+        const double geo_distance = geo::ComputeDistance(coordinates[vertex], coordinates[target])
+            - DISTANCE_TOLERANCE;
+        // acos  geo::ComputeDistance   NaN    
+        return geo_distance > 0 ? geo_distance * minutes_per_meter : 0.0;
+    };
 }
 
 std::optional<RouteResponse> TransportRouter::GetRoute(std::string_view from, std::string_view to) const {
-    if (router_ == nullptr) {
-        router_ = std::make_unique<graph::Router<double>>(graph_);
+    if (route_cache_.GetCapacity() == 0) {
+        return BuildRoute(from, to);
     }
-    
-    auto route_info = router_->BuildRoute(FindVertexIdByStopName(from), FindVertexIdByStopName(to));
+    const auto key = MakeVertexPairKey(FindVertexIdByStopName(from), FindVertexIdByStopName(to));
+    if (auto response = route_cache_.Get(key)) {
+        return std::move(*response);
+    }
+    auto response = BuildRoute(from, to);
+    route_cache_.Put(key, response);
+    return response;
+}
+
+size_t TransportRouter::VertexPairHasher::operator()(VertexPairKey key) const {
+    return static_cast<size_t>(hashing::MixBits(key));
+}
+
+TransportRouter::VertexPairKey TransportRouter::MakeVertexPairKey(graph::VertexId from, graph::VertexId to) {
+    return (static_cast<VertexPairKey>(from) << 32) | static_cast<uint32_t>(to);
+}
+
+cache::CacheStats TransportRouter::GetRouteCacheStats() const {
+    return route_cache_.GetStats();
+}
+
+void TransportRouter::ClearRouteCache() const {
+    route_cache_.Clear();
+}
+
+size_t TransportRouter::GetPrunedEdgeCount() const {
+    return pruned_edge_count_;
+}
+
+std::optional<RouteResponse> TransportRouter::BuildRoute(std::string_view from, std::string_view to) const {
+    if (raptor_ != nullptr) {
+        return raptor_->BuildRoute(from, to);
+    }
+    const graph::VertexId vertex_from = FindVertexIdByStopName(from);
+    const graph::VertexId vertex_to = FindVertexIdByStopName(to);
+    if (!components_.MayReach(vertex_from, vertex_to)) {
+        return std::nullopt;
+    }
+    auto route_info = GetRoutingEngine().BuildRoute(vertex_from, vertex_to);
     if (!route_info) {
         return std::nullopt;
     }
@@ -32,45 +273,166 @@ std::optional<RouteResponse> TransportRouter::GetRoute(std::string_view from, st
     response.total_time = route_info.value().weight;
 
     for (const auto edge_id : route_info.value().edges) {
-        response.time_cuts.push_back(FindTimecutByEdgeId(edge_id));
+        AddTimecutsByEdgeId(edge_id, response.time_cuts);
     }
 
     return response;
 }
 
+TravelTimeMatrix TransportRouter::GetTravelTimes(const std::vector<std::string_view>& from,
+    const std::vector<std::string_view>& to) const {
+    //      
+    std::vector<std::string_view> sources;
+    std::unordered_map<std::string_view, size_t> source_indices;
+    for (const auto stop_name : from) {
+        if (source_indices.insert({ stop_name, sources.size() }).second) {
+            sources.push_back(stop_name);
+        }
+    }
+
+    std::vector<graph::VertexId> vertices_to;
+    if (raptor_ == nullptr) {
+        GetRoutingEngine();
+        vertices_to.reserve(to.size());
+        for (const auto stop_name : to) {
+            vertices_to.push_back(FindVertexIdByStopName(stop_name));
+        }
+    }
+
+    std::vector<std::vector<std::optional<double>>> source_rows(sources.size());
+    parallel::ForEachChunk(sources.size(), parallel::GetThreadCount(settings_.thread_count),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                source_rows[i] = raptor_ != nullptr
+                    ? raptor_->BuildTimes(sources[i], to)
+                    : BuildTimes(FindVertexIdByStopName(sources[i]), vertices_to);
+            }
+        });
+
+    TravelTimeMatrix matrix;
+    matrix.reserve(from.size());
+    for (const auto stop_name : from) {
+        matrix.push_back(source_rows[source_indices.at(stop_name)]);
+    }
+    return matrix;
+}
+
+std::vector<std::optional<double>> TransportRouter::BuildTimes(graph::VertexId from,
+    const std::vector<graph::VertexId>& to) const {
+    std::vector<std::optional<double>> times(to.size());
+    std::vector<graph::VertexId> reachable_to;
+    std::vector<size_t> reachable_indices;
+    for (size_t i = 0; i < to.size(); ++i) {
+        if (components_.MayReach(from, to[i])) {
+            reachable_to.push_back(to[i]);
+            reachable_indices.push_back(i);
+        }
+    }
+    if (reachable_to.empty()) {
+        return times;
+    }
+    const auto reachable_times = GetRoutingEngine().BuildWeights(from, reachable_to);
+    for (size_t i = 0; i < reachable_indices.size(); ++i) {
+        times[reachable_indices[i]] = reachable_times[i];
+    }
+    return times;
+}
+
 void TransportRouter::InitializeStops() {
-    //    VertexId   
+    //    VertexId   ,     
     graph::VertexId vertexId = 0;
-    for (const auto& [stop_name, _] : catalogue_.GetAllStops()) {
-        stops_ids_table_.insert({ stop_name, vertexId });
+    for (StopId stop = 0; stop < catalogue_.GetStopCount(); ++stop) {
+        stop_vertices_.push_back(vertexId);
+        stop_names_.push_back(catalogue_.GetStopName(stop));
+        vertex_stops_.insert(vertex_stops_.end(), GetVertexCountPerStop(), static_cast<uint32_t>(stop));
         //       .
         //     ,       ,
         //     +1 ,    .
-        vertexId += 2;
+        //      ,    
+        vertexId += GetVertexCountPerStop();
+    }
+}
+
+TransportRouter::RoutingGraph TransportRouter::CreateGraph(size_t vertex_count) const {
+    const bool keep_reverse_edges = settings_.router_type == RouterType::BIDIRECTIONAL_DIJKSTRA;
+    if (settings_.use_integer_weights) {
+        return graph::DirectedWeightedGraph<graph::DeciSeconds>(vertex_count, keep_reverse_edges);
     }
+    return graph::DirectedWeightedGraph<double>(vertex_count, keep_reverse_edges);
 }
 
 void TransportRouter::InitializeGraph() {
-    graph_ = graph::DirectedWeightedGraph<double>{ catalogue_.GetAllStops().size() * 2 };
+    graph_ = CreateGraph(catalogue_.GetStopCount() * GetVertexCountPerStop());
+    std::visit([this](auto& graph) {
+        AddEdges(graph);
+    }, graph_);
+}
 
+template <typename Weight>
+void TransportRouter::AddEdges(graph::DirectedWeightedGraph<Weight>& graph) {
     //          
-    for (const auto& [stop_name, vertexId] : stops_ids_table_) {
-        auto edge_id = graph_.AddEdge({ vertexId, vertexId + 1, settings_.bus_wait_time });
-        time_cuts_[edge_id] = Wait{ settings_.bus_wait_time, stop_name };
+    if (settings_.graph_model == GraphModel::WAIT_EDGES) {
+        for (StopId stop = 0; stop < stop_names_.size(); ++stop) {
+            const graph::VertexId vertexId = stop_vertices_[stop];
+            graph.AddEdge({ vertexId, GetDepartureVertex(vertexId), ComputeWaitWeight<Weight>() });
+            edge_annotations_.Add(EdgeKind::WAIT, stop, 0, 0);
+        }
     }
 
     //       
     // : A -> B, A -> C, A -> D; B -> C, B -> D  ..
     // (  D -> D   , 
     //        )
-    BusesTable buses_table = catalogue_.GetAllBuses();
-    for (const auto& [name, bus_ptr] : buses_table) {
-        CreateEdgesBetweenStops(name, bus_ptr);
+    //    ,        ,
+    //        
+    const size_t bus_count = catalogue_.GetBusCount();
+    std::vector<BusEdges<Weight>> buses_edges(bus_count);
+    parallel::ForEachChunk(bus_count, parallel::GetThreadCount(settings_.thread_count),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                buses_edges[i] = CreateEdgesBetweenStops<Weight>(&catalogue_.GetBus(static_cast<BusId>(i)));
+            }
+        });
+    if (settings_.prune_parallel_edges) {
+        pruned_edge_count_ = PruneParallelEdges<Weight>(buses_edges);
+    }
+    for (BusId bus = 0; bus < bus_count; ++bus) {
+        bus_names_.push_back(catalogue_.GetBus(bus).name);
+        for (const auto& [edge, ride] : buses_edges[bus]) {
+            graph.AddEdge(edge);
+            edge_annotations_.Add(EdgeKind::BUS, bus, ride.span_count, ride.distance);
+        }
     }
+
+    //    ,        
+    graph.Freeze();
 }
 
-void TransportRouter::CreateEdgesBetweenStops(std::string_view bus_name, const Bus* const bus_ptr) {
-    auto stops = bus_ptr->stops;
+template <typename Weight>
+TransportRouter::BusEdges<Weight> TransportRouter::CreateEdgesBetweenStops(const Bus* const bus_ptr) const {
+    const auto& stops = bus_ptr->stops;
+    BusEdges<Weight> edges;
+    if (stops.size() < 2) {
+        return edges;
+    }
+
+    //           ,
+    //   i -> j    
+    std::vector<graph::VertexId> vertex_ids(stops.size());
+    std::vector<int64_t> distances(stops.size(), 0);
+    std::vector<int64_t> distances_inverse(stops.size(), 0);
+    for (size_t k = 0; k < stops.size(); ++k) {
+        vertex_ids[k] = stop_vertices_[stops[k]->id];
+        if (k > 0) {
+            distances[k] = distances[k - 1] + catalogue_.GetDistance(stops[k - 1], stops[k]);
+            distances_inverse[k] = distances_inverse[k - 1] + catalogue_.GetDistance(stops[k], stops[k - 1]);
+        }
+    }
+
+    //        
+    const Weight boarding_time = settings_.graph_model == GraphModel::BOARDING_WAIT
+        ? ComputeWaitWeight<Weight>() : Weight{};
+
     for (size_t i = 0; i < stops.size() - 1; ++i) {
         //    ,      
         if (!bus_ptr->is_round && i >= stops.size() / 2) {
@@ -81,36 +443,252 @@ void TransportRouter::CreateEdgesBetweenStops(std::string_view bus_name, const B
             if (!bus_ptr->is_round && j > stops.size() / 2) {
                 break;
             }
-            //    (  )
-            //   
-            double stops_distance = 0;
-            double stops_distance_inverse = 0;
-            for (size_t k = i + 1; k <= j; ++k) {
-                stops_distance += catalogue_.GetDistance(stops[k - 1], stops[k]);
-                stops_distance_inverse += catalogue_.GetDistance(stops[k], stops[k - 1]);
-            }
-            auto edge_id = graph_.AddEdge({
-                FindVertexIdByStopName(stops[i]->name) + 1, //   +1   
-                FindVertexIdByStopName(stops[j]->name),
-                stops_distance / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR });
-            time_cuts_[edge_id] = RidingBus{
-                /*time*/ stops_distance / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR,
-                /*bus_name*/ bus_name,
-                /*span_count*/ j - i };
+            //   (  )   
+            const double stops_distance = static_cast<double>(distances[j] - distances[i]);
+            const double stops_distance_inverse = static_cast<double>(distances_inverse[j] - distances_inverse[i]);
+            const Weight time = boarding_time + ComputeRideWeight<Weight>(stops_distance);
+            edges.push_back({
+                { GetDepartureVertex(vertex_ids[i]), vertex_ids[j], time }, //   +1   
+                { static_cast<uint32_t>(j - i), stops_distance } });
 
             //     ,    
             if (!bus_ptr->is_round) {
-                auto edge_id = graph_.AddEdge({
-                    FindVertexIdByStopName(stops[j]->name) + 1,
-                    FindVertexIdByStopName(stops[i]->name),
-                    stops_distance_inverse / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR });
-                time_cuts_[edge_id] = RidingBus{
-                    /*time*/ stops_distance_inverse / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR,
-                    /*bus_name*/ bus_name,
-                    /*span_count*/ j - i };
+                const Weight time_inverse = boarding_time + ComputeRideWeight<Weight>(stops_distance_inverse);
+                edges.push_back({
+                    { GetDepartureVertex(vertex_ids[j]), vertex_ids[i], time_inverse },
+                    { static_cast<uint32_t>(j - i), stops_distance_inverse } });
             }
         }
     }
+    return edges;
+}
+
+template <typename Weight>
+Weight TransportRouter::ComputeWaitWeight() const {
+    if constexpr (std::is_same_v<Weight, double>) {
+        return settings_.bus_wait_time;
+    }
+    else {
+        return Weight::RoundUp(settings_.bus_wait_time * Weight::PER_MINUTE);
+    }
+}
+
+template <typename Weight>
+Weight TransportRouter::ComputeRideWeight(double distance) const {
+    if constexpr (std::is_same_v<Weight, double>) {
+        return distance / METERS_IN_KILOMETERS / settings_.bus_velocity * MINUTES_IN_HOUR;
+    }
+    else {
+        //     /        36:
+        //      ,     
+        static const double PER_METER = Weight::PER_MINUTE * MINUTES_IN_HOUR / METERS_IN_KILOMETERS;
+        return Weight::RoundUp(distance * PER_METER / settings_.bus_velocity);
+    }
+}
+
+template <typename Weight>
+size_t TransportRouter::PruneParallelEdges(std::vector<BusEdges<Weight>>& buses_edges) const {
+    //           .
+    //          :  
+    //     ,    
+    using EdgePosition = std::pair<uint32_t, uint32_t>; //       
+    static const EdgePosition NO_EDGE = { std::numeric_limits<uint32_t>::max(), 0 };
+    const size_t vertex_count = GetVertexCount();
+
+    //     ,   
+    std::vector<size_t> offsets(vertex_count + 1, 0);
+    for (const auto& bus_edges : buses_edges) {
+        for (const auto& [edge, _] : bus_edges) {
+            ++offsets[edge.from + 1];
+        }
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+    std::vector<EdgePosition> positions(offsets.back());
+    std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+    std::vector<std::vector<bool>> removed(buses_edges.size());
+    for (uint32_t bus = 0; bus < buses_edges.size(); ++bus) {
+        removed[bus].assign(buses_edges[bus].size(), false);
+        for (uint32_t index = 0; index < buses_edges[bus].size(); ++index) {
+            positions[filled[buses_edges[bus][index].first.from]++] = { bus, index };
+        }
+    }
+
+    //         
+    std::vector<EdgePosition> lightest(vertex_count, NO_EDGE);
+    std::vector<graph::VertexId> touched;
+    size_t removed_count = 0;
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        for (size_t k = offsets[vertex]; k < offsets[vertex + 1]; ++k) {
+            const auto [bus, index] = positions[k];
+            const auto& edge = buses_edges[bus][index].first;
+            EdgePosition& best = lightest[edge.to];
+            if (best == NO_EDGE) {
+                best = positions[k];
+                touched.push_back(edge.to);
+                continue;
+            }
+            if (edge.weight < buses_edges[best.first][best.second].first.weight) {
+                removed[best.first][best.second] = true;
+                best = positions[k];
+            }
+            else {
+                removed[bus][index] = true;
+            }
+            ++removed_count;
+        }
+        for (const graph::VertexId vertex_to : touched) {
+            lightest[vertex_to] = NO_EDGE;
+        }
+        touched.clear();
+    }
+
+    for (uint32_t bus = 0; bus < buses_edges.size(); ++bus) {
+        auto& bus_edges = buses_edges[bus];
+        size_t kept = 0;
+        for (size_t index = 0; index < bus_edges.size(); ++index) {
+            if (!removed[bus][index]) {
+                bus_edges[kept++] = bus_edges[index];
+            }
+        }
+        bus_edges.resize(kept);
+    }
+    return removed_count;
+}
+
+bool TransportRouter::LoadSnapshot() {
+    try {
+        auto snapshot = std::make_unique<SnapshotReader>(settings_.snapshot_file);
+        if (!snapshot->IsValid(ComputeRoutingHash(catalogue_, settings_))) {
+            return false;
+        }
+        const size_t vertex_count = snapshot->GetHeader().vertex_count;
+
+        //        ,     
+        const auto snapshot_stop_names = snapshot->GetStrings(SnapshotSection::STOP_NAMES);
+        const auto stop_vertices = snapshot->GetSection<uint64_t>(SnapshotSection::STOP_VERTICES);
+        if (snapshot_stop_names.size() != static_cast<size_t>(stop_vertices.end() - stop_vertices.begin())
+            || snapshot_stop_names.size() != catalogue_.GetStopCount()) {
+            return false;
+        }
+        //       ,  
+        //     
+        std::vector<std::string_view> stop_names;
+        std::vector<graph::VertexId> stop_vertices_by_id(catalogue_.GetStopCount());
+        std::vector<uint32_t> vertex_stops(vertex_count);
+        for (size_t i = 0; i < snapshot_stop_names.size(); ++i) {
+            const StopId stop = catalogue_.FindStopId(snapshot_stop_names[i]);
+            const graph::VertexId vertex = stop_vertices.begin()[i];
+            if (vertex + GetVertexCountPerStop() > vertex_count) {
+                return false;
+            }
+            stop_names.push_back(catalogue_.GetStopName(stop));
+            stop_vertices_by_id[stop] = vertex;
+            std::fill_n(vertex_stops.begin() + vertex, GetVertexCountPerStop(), static_cast<uint32_t>(i));
+        }
+        std::vector<std::string_view> bus_names;
+        for (const auto bus_name : snapshot->GetStrings(SnapshotSection::BUS_NAMES)) {
+            bus_names.push_back(catalogue_.FindBusByName(bus_name)->name);
+        }
+
+        const auto edges = snapshot->GetSection<SnapshotEdge>(SnapshotSection::EDGES);
+        const auto annotations = snapshot->GetSection<SnapshotEdgeAnnotation>(SnapshotSection::EDGE_ANNOTATIONS);
+        if (edges.end() - edges.begin() != annotations.end() - annotations.begin()) {
+            return false;
+        }
+        graph::DirectedWeightedGraph<double> graph(vertex_count);
+        EdgeAnnotations edge_annotations;
+        for (size_t i = 0; i < static_cast<size_t>(edges.end() - edges.begin()); ++i) {
+            const SnapshotEdge& edge = edges.begin()[i];
+            const SnapshotEdgeAnnotation& annotation = annotations.begin()[i];
+            const bool is_wait = annotation.kind == SnapshotEdgeKind::WAIT;
+            if (edge.from >= vertex_count || edge.to >= vertex_count
+                || annotation.name_index >= (is_wait ? stop_names.size() : bus_names.size())) {
+                return false;
+            }
+            graph.AddEdge({ edge.from, edge.to, edge.weight });
+            edge_annotations.Add(is_wait ? EdgeKind::WAIT : EdgeKind::BUS, annotation.name_index,
+                static_cast<uint32_t>(annotation.span_count), annotation.distance);
+        }
+        graph.Freeze();
+
+        stop_vertices_ = std::move(stop_vertices_by_id);
+        stop_names_ = std::move(stop_names);
+        vertex_stops_ = std::move(vertex_stops);
+        bus_names_ = std::move(bus_names);
+        graph_ = std::move(graph);
+        edge_annotations_ = std::move(edge_annotations);
+        //         
+        const auto weights = snapshot->GetSection<double>(SnapshotSection::ROUTES_WEIGHTS);
+        const auto prev_edges = snapshot->GetSection<graph::Router<double>::PrevEdge>(
+            SnapshotSection::ROUTES_PREV_EDGES);
+        router_ = std::make_unique<graph::Router<double>>(std::get<graph::DirectedWeightedGraph<double>>(graph_),
+            graph::FlatBuffer<double>::View(weights.begin(), weights.end() - weights.begin()),
+            graph::FlatBuffer<graph::Router<double>::PrevEdge>::View(prev_edges.begin(),
+                prev_edges.end() - prev_edges.begin()));
+        router_ready_.store(true, std::memory_order_release);
+        snapshot_ = std::move(snapshot);
+        return true;
+    }
+    catch (const std::exception&) {
+        //       
+        stop_vertices_.clear();
+        stop_names_.clear();
+        vertex_stops_.clear();
+        bus_names_.clear();
+        edge_annotations_ = {};
+        graph_ = RoutingGraph{};
+        router_ = nullptr;
+        return false;
+    }
+}
+
+bool TransportRouter::UsesSnapshot() const {
+    return !settings_.snapshot_file.empty() && settings_.router_type == RouterType::ALL_PAIRS
+        && !settings_.use_integer_weights;
+}
+
+void TransportRouter::TrySaveSnapshot(const graph::Router<double>& routes_table) const {
+    try {
+        SaveSnapshot(routes_table);
+    }
+    catch (const std::exception& e) {
+        //     ,     
+        std::cerr << "Routing snapshot isn't saved: " << e.what() << std::endl;
+    }
+}
+
+void TransportRouter::SaveSnapshot(const graph::Router<double>& routes_table) const {
+    const auto& graph = std::get<graph::DirectedWeightedGraph<double>>(graph_);
+    SnapshotWriter writer(settings_.snapshot_file, ComputeRoutingHash(catalogue_, settings_), graph.GetVertexCount());
+
+    std::vector<uint64_t> stop_vertices;
+    for (const auto stop_name : stop_names_) {
+        stop_vertices.push_back(FindVertexIdByStopName(stop_name));
+    }
+
+    std::vector<SnapshotEdge> edges;
+    std::vector<SnapshotEdgeAnnotation> annotations;
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        edges.push_back({ edge.from, edge.to, edge.weight });
+        annotations.push_back({
+            edge_annotations_.kinds[edge_id] == EdgeKind::WAIT ? SnapshotEdgeKind::WAIT : SnapshotEdgeKind::BUS,
+            edge_annotations_.names[edge_id], edge_annotations_.span_counts[edge_id],
+            edge_annotations_.distances[edge_id] });
+    }
+
+    writer.WriteStrings(SnapshotSection::STOP_NAMES, stop_names_);
+    writer.WriteSection(SnapshotSection::STOP_VERTICES, stop_vertices.data(), stop_vertices.size());
+    writer.WriteStrings(SnapshotSection::BUS_NAMES, bus_names_);
+    writer.WriteSection(SnapshotSection::EDGES, edges.data(), edges.size());
+    writer.WriteSection(SnapshotSection::EDGE_ANNOTATIONS, annotations.data(), annotations.size());
+    writer.WriteSection(SnapshotSection::ROUTES_WEIGHTS, routes_table.GetWeights().Data(),
+        routes_table.GetWeights().Size());
+    writer.WriteSection(SnapshotSection::ROUTES_PREV_EDGES, routes_table.GetPrevEdges().Data(),
+        routes_table.GetPrevEdges().Size());
+    writer.Commit();
 }
 
 } // namespace router
\ No newline at end of file
@@ -1,13 +1,30 @@
 #pragma once
 
+#include "a_star_router.h"
+#include "bidirectional_dijkstra_router.h"
+#include "connected_components.h"
+#include "contraction_hierarchies.h"
+#include "deci_seconds.h"
+#include "dijkstra_router.h"
 #include "domain.h"
+#include "lru_cache.h"
+#include "raptor_router.h"
 #include "router.h"
+#include "router_snapshot.h"
+#include "shortest_path_tree_router.h"
 #include "transport_catalogue.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace router {
 
@@ -18,24 +35,126 @@ class TransportRouter {
 public:
     TransportRouter(RoutingSettings settings, const transport_catalogue::TransportCatalogue& catalogue);
     std::optional<RouteResponse> GetRoute(std::string_view from, std::string_view to) const;
+    // одинаковые остановки отправления обрабатываются один раз, разные - параллельно
+    TravelTimeMatrix GetTravelTimes(const std::vector<std::string_view>& from,
+        const std::vector<std::string_view>& to) const;
+
+    // Готов ли маршрутизатор. Ожидание строит его в текущем потоке, если фоновой сборки нет;
+    // с таймаутом возвращает false, если фоновая сборка не успела закончиться
+    bool IsReady() const;
+    void WaitUntilReady() const;
+    bool WaitUntilReady(std::chrono::milliseconds timeout) const;
+
+    cache::CacheStats GetRouteCacheStats() const;
+    void ClearRouteCache() const;
+
+    // сколько параллельных рёбер автобусов отброшено при построении графа
+    // (при загрузке графа из снимка отбрасывать уже нечего)
+    size_t GetPrunedEdgeCount() const;
 
 private:
+    // ключ кэша маршрутов - пара 32-битных номеров вершин (from << 32 | to)
+    using VertexPairKey = uint64_t;
+    struct VertexPairHasher {
+        size_t operator()(VertexPairKey key) const;
+    };
+    static VertexPairKey MakeVertexPairKey(graph::VertexId from, graph::VertexId to);
+
+    std::optional<RouteResponse> BuildRoute(std::string_view from, std::string_view to) const;
+    // времена до вершин to, недостижимые по компонентам связности вершины движку не передаются
+    std::vector<std::optional<double>> BuildTimes(graph::VertexId from, const std::vector<graph::VertexId>& to) const;
     graph::VertexId FindVertexIdByStopName(std::string_view stop_name) const;
-    Timecut FindTimecutByEdgeId(graph::EdgeId edge_id) const;
+    // ребро поездки в модели без рёбер ожидания даёт два элемента: ожидание и саму поездку
+    void AddTimecutsByEdgeId(graph::EdgeId edge_id, std::vector<Timecut>& time_cuts) const;
+    // сколько вертексов приходится на остановку и из какого вертекса остановки уезжают автобусы
+    size_t GetVertexCountPerStop() const;
+    graph::VertexId GetDepartureVertex(graph::VertexId stop_vertex) const;
+    size_t GetVertexCount() const;
+    std::unique_ptr<graph::RoutingEngine<double>> CreateRoutingEngine() const;
+    template <typename Weight>
+    std::unique_ptr<graph::RoutingEngine<Weight>> CreateRoutingEngine(
+        const graph::DirectedWeightedGraph<Weight>& graph) const;
+    const graph::RoutingEngine<double>& GetRoutingEngine() const;
+    graph::Heuristic<double> CreateDistanceHeuristic() const;
+
+    // граф в минутах или, с целочисленными весами, сразу в десятых долях секунды
+    using RoutingGraph = std::variant<graph::DirectedWeightedGraph<double>,
+        graph::DirectedWeightedGraph<graph::DeciSeconds>>;
+    RoutingGraph CreateGraph(size_t vertex_count) const;
 
     void InitializeStops();
     void InitializeGraph();
+    template <typename Weight>
+    void AddEdges(graph::DirectedWeightedGraph<Weight>& graph);
+
+    // Снимок хранит граф и таблицу всех маршрутов, поэтому нужен только ALL_PAIRS на вещественных весах.
+    // Загрузка берёт его, если он построен по тем же данным; ошибка сохранения, как и загрузки, не фатальна
+    bool UsesSnapshot() const;
+    bool LoadSnapshot();
+    void TrySaveSnapshot(const graph::Router<double>& routes_table) const;
+    void SaveSnapshot(const graph::Router<double>& routes_table) const;
 
-    void CreateEdgesBetweenStops(std::string_view bus_name, const Bus* const bus_ptr);
+    // поездка по ребру автобуса: сколько остановок проехано и сколько метров
+    struct BusRide {
+        uint32_t span_count;
+        double distance;
+    };
+    template <typename Weight>
+    using BusEdges = std::vector<std::pair<graph::Edge<Weight>, BusRide>>;
+    template <typename Weight>
+    BusEdges<Weight> CreateEdgesBetweenStops(const Bus* const bus_ptr) const;
+    // оставляет из рёбер с общим началом и концом только самое лёгкое, возвращает число удалённых
+    template <typename Weight>
+    size_t PruneParallelEdges(std::vector<BusEdges<Weight>>& buses_edges) const;
+    // время ожидания и поездки в весах графа, десятые доли секунды округляются вверх
+    template <typename Weight>
+    Weight ComputeWaitWeight() const;
+    template <typename Weight>
+    Weight ComputeRideWeight(double distance) const;
+
+    enum class EdgeKind : uint8_t {
+        WAIT,
+        BUS,
+    };
+
+    // Описания рёбер графа по столбцам, индекс - номер ребра. Время отдельно не хранится:
+    // ожидание совпадает с весом ребра, а поездка считается по своей длине так же, как при
+    // построении графа, поэтому и в модели без рёбер ожидания она не зависит от ожидания
+    struct EdgeAnnotations {
+        std::vector<EdgeKind> kinds;
+        std::vector<uint32_t> names; // номер в stop_names_ для ожидания, в bus_names_ для поездки
+        std::vector<uint32_t> span_counts;
+        std::vector<double> distances; // длина поездки в метрах, у ожидания 0
+
+        void Add(EdgeKind kind, uint32_t name, uint32_t span_count, double distance);
+    };
 
     RoutingSettings settings_;
     const transport_catalogue::TransportCatalogue& catalogue_;
 
-    std::unordered_map<std::string_view, graph::VertexId> stops_ids_table_;
-    std::unordered_map<graph::EdgeId, Timecut> time_cuts_;
-    graph::DirectedWeightedGraph<double> graph_;
+    std::vector<graph::VertexId> stop_vertices_; // индекс - StopId
+    std::vector<std::string_view> stop_names_; // в порядке вертексов
+    std::vector<uint32_t> vertex_stops_; // индекс - VertexId, значение - номер в stop_names_
+    std::vector<std::string_view> bus_names_;
+    EdgeAnnotations edge_annotations_;
+    RoutingGraph graph_;
+    size_t pruned_edge_count_ = 0;
+    // отсекает маршруты между несвязанными частями сети, не обращаясь к маршрутизатору
+    graph::ConnectedComponents components_;
+
+    // снимок должен жить дольше маршрутизатора, который может ссылаться на его память
+    std::unique_ptr<SnapshotReader> snapshot_ = nullptr;
+    // маршрутизатор строится один раз, после этого обращения к нему не блокируются
+    mutable std::unique_ptr<graph::RoutingEngine<double>> router_ = nullptr;
+    mutable std::once_flag router_once_;
+    mutable std::atomic<bool> router_ready_ = false;
+    std::unique_ptr<RaptorRouter> raptor_ = nullptr;
+
+    // готовые ответы для частых пар остановок
+    mutable cache::LruCache<VertexPairKey, std::optional<RouteResponse>, VertexPairHasher> route_cache_;
 
-    mutable std::unique_ptr<graph::Router<double>> router_ = nullptr;
+    // последним полем, чтобы фоновая сборка завершилась раньше, чем разрушатся остальные поля
+    std::shared_future<void> warm_up_;
 };
 
 } // namespace router
\ No newline at end of file